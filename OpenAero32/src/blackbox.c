@@ -0,0 +1,198 @@
+/*
+ * Blackbox flight recorder
+ *
+ * While armed, every cfg.blackbox_rate-th control loop is logged to the main uart.
+ * A log starts with text header lines ("H ...") naming the fields, followed by frames.
+ * Intra frames ('I') carry the field values, the frames in between ('P') only the
+ * change from the previous frame. Every value is zigzag and varint coded, so a typical
+ * frame is around 30 bytes. Frames are coded into a RAM ring from the control loop and
+ * serialCom() moves them into the uart tx ring without ever waiting on it. A frame that
+ * doesn't fit is dropped and the next one is sent as an intra frame.
+ * tools/blackbox_decode.c turns a log into CSV.
+ */
+#include "board.h"
+#include "mw.h"
+
+// from mixer.c
+extern uint8_t numberMotor;
+extern uint8_t useServo;
+
+#define BLACKBOX_BUFFER_SIZE    1024        // must be a power of 2
+#define BLACKBOX_INTRA_INTERVAL 32          // frames between intra frames
+#define BLACKBOX_MAX_FIELDS     40
+#define BLACKBOX_CHUNK          64          // bytes moved into the uart ring at a time
+
+static uint8_t buffer[BLACKBOX_BUFFER_SIZE];
+static uint16_t bufferHead = 0;
+static uint16_t bufferTail = 0;
+
+static int32_t fields[BLACKBOX_MAX_FIELDS];
+static int32_t lastFields[BLACKBOX_MAX_FIELDS];
+static uint8_t frame[1 + BLACKBOX_MAX_FIELDS * 5];
+static uint32_t frameIndex;
+static uint32_t loopIteration;
+static bool logging = false;
+uint32_t blackboxDropped = 0;
+
+static const char headerFields[] =
+    "H fields:loopIteration,time,"
+    "gyroADC[0],gyroADC[1],gyroADC[2],accADC[0],accADC[1],accADC[2],"
+    "rcCommand[0],rcCommand[1],rcCommand[2],rcCommand[3],axisPID[0],axisPID[1],axisPID[2]";
+
+static uint16_t bufferFree(void)
+{
+    return (bufferTail - bufferHead - 1) & (BLACKBOX_BUFFER_SIZE - 1);
+}
+
+static void bufferPut(const uint8_t *data, uint16_t len)
+{
+    while (len--) {
+        buffer[bufferHead] = *data++;
+        bufferHead = (bufferHead + 1) & (BLACKBOX_BUFFER_SIZE - 1);
+    }
+}
+
+static void bufferPrint(const char *s)
+{
+    uint16_t len = strlen(s);
+
+    if (len <= bufferFree())
+        bufferPut((const uint8_t *)s, len);
+}
+
+// 7 bits per byte, low bits first, top bit set on all but the last byte
+static uint8_t *putVarint(uint8_t *p, uint32_t value)
+{
+    while (value > 0x7F) {
+        *p++ = value | 0x80;
+        value >>= 7;
+    }
+    *p++ = value;
+    return p;
+}
+
+// fold the sign into bit 0 so small negative values stay small
+static uint32_t zigzag(int32_t value)
+{
+    return (value << 1) ^ (value >> 31);
+}
+
+// keep in sync with the header written by blackboxStart()
+static uint8_t getFields(int32_t *v)
+{
+    uint8_t n = 0;
+    uint8_t i;
+
+    v[n++] = loopIteration;
+    v[n++] = currentTime;
+    for (i = 0; i < 3; i++)
+        v[n++] = gyroADC[i];
+    for (i = 0; i < 3; i++)
+        v[n++] = accADC[i];
+    for (i = 0; i < 4; i++)
+        v[n++] = rcCommand[i];
+    for (i = 0; i < 3; i++)
+        v[n++] = axisPID[i];
+    for (i = 0; i < numberMotor; i++)
+        v[n++] = motor[i];
+    if (useServo) {
+        for (i = 0; i < 8; i++)
+            v[n++] = servo[i];
+    }
+    v[n++] = cycleTime;
+    v[n++] = BaroAlt;
+    return n;
+}
+
+static void blackboxStart(void)
+{
+    char line[16];
+    uint8_t i;
+
+    loopIteration = 0;
+    frameIndex = 0;
+    blackboxDropped = 0;
+
+    sprintf(line, "H rate:%d\n", cfg.blackbox_rate);
+    bufferPrint("H OpenAero32 blackbox 1\n");
+    bufferPrint(line);
+    bufferPrint(headerFields);
+    for (i = 0; i < numberMotor; i++) {
+        sprintf(line, ",motor[%d]", i);
+        bufferPrint(line);
+    }
+    if (useServo) {
+        for (i = 0; i < 8; i++) {
+            sprintf(line, ",servo[%d]", i);
+            bufferPrint(line);
+        }
+    }
+    bufferPrint(",cycleTime,BaroAlt\n");
+    logging = true;
+}
+
+static void blackboxWriteFrame(void)
+{
+    uint8_t *p = frame;
+    bool intra = (frameIndex % BLACKBOX_INTRA_INTERVAL) == 0;
+    uint8_t i, n;
+
+    n = getFields(fields);
+    *p++ = intra ? 'I' : 'P';
+    for (i = 0; i < n; i++) {
+        p = putVarint(p, zigzag(intra ? fields[i] : fields[i] - lastFields[i]));
+        lastFields[i] = fields[i];
+    }
+
+    if (p - frame > bufferFree()) {
+        blackboxDropped++;
+        frameIndex = 0;         // the decoder lost the reference, restart with an intra frame
+        return;
+    }
+    bufferPut(frame, p - frame);
+    frameIndex++;
+}
+
+// call once per control loop, after the motors have been written
+void blackboxUpdate(void)
+{
+    if (!feature(FEATURE_BLACKBOX) || feature(FEATURE_TELEMETRY))
+        return;
+
+    if (f.ARMED && !logging)
+        blackboxStart();
+    if (!logging)
+        return;
+
+    if (!f.ARMED) {
+        bufferPrint("E\n");
+        logging = false;
+        return;
+    }
+
+    if (loopIteration % cfg.blackbox_rate == 0)
+        blackboxWriteFrame();
+    loopIteration++;
+}
+
+// Move logged bytes into the uart tx ring, as much as fits right now.
+// Returns true while the log owns the serial port.
+bool blackboxFlush(void)
+{
+    uint16_t len;
+    uint8_t *p;
+
+    while (bufferTail != bufferHead) {
+        len = (bufferHead > bufferTail ? bufferHead : BLACKBOX_BUFFER_SIZE) - bufferTail;
+        if (len > BLACKBOX_CHUNK)
+            len = BLACKBOX_CHUNK;
+        p = uartReserve(len);
+        if (!p)
+            break;
+        memcpy(p, &buffer[bufferTail], len);
+        uartCommit(len);
+        bufferTail = (bufferTail + len) & (BLACKBOX_BUFFER_SIZE - 1);
+    }
+
+    return logging || bufferTail != bufferHead;
+}
@@ -19,6 +19,8 @@
 #define M_PI       3.14159265358979323846f
 #endif /* M_PI */
 
+#include "fastmath.h"
+
 typedef enum {
     SENSOR_ACC = 1 << 0,
     SENSOR_BARO = 1 << 1,
@@ -47,6 +49,8 @@ typedef enum {
     FEATURE_FAILSAFE = 1 << 9,
     FEATURE_TELEMETRY = 1 << 11,
 	FEATURE_POWERMETER = 1 << 12,
+    FEATURE_GYRO_SYNC = 1 << 13,
+    FEATURE_BLACKBOX = 1 << 14,
 } AvailableFeatures;
 
 typedef enum {
@@ -55,6 +59,11 @@ typedef enum {
     GPS_MTK,
 } GPSHardware;
 
+typedef enum {
+    TELEMETRY_FRSKY = 0,
+    TELEMETRY_SMARTPORT,
+} TelemetryProvider;
+
 typedef void (* sensorInitFuncPtr)(void);                   // sensor init prototype
 typedef void (* sensorReadFuncPtr)(int16_t *data);          // sensor read and align prototype
 typedef int32_t (* baroCalculateFuncPtr)(void);             // baro calculation (returns altitude in cm based on static data collected)
@@ -67,6 +76,7 @@ typedef struct sensor_t
     sensorReadFuncPtr read;
     sensorReadFuncPtr align;
     sensorReadFuncPtr temperature;
+    sensorInitFuncPtr start;                                // optional, begin fetching the next sample in the background
 } sensor_t;
 
 typedef struct baro_t
@@ -13,7 +13,9 @@ static void cliMap(char *cmdline);
 static void cliMixer(char *cmdline);
 static void cliSave(char *cmdline);
 static void cliSet(char *cmdline);
+static void cliSMix(char *cmdline);
 static void cliStatus(char *cmdline);
+static void cliTasks(char *cmdline);
 static void cliVersion(char *cmdline);
 
 // from sensors.c
@@ -35,14 +37,21 @@ const char * const mixerNames[] = {
     "TRI", "QUADP", "QUADX", "BI",
     "GIMBAL", "Y6", "HEX6",
     "FLYING_WING", "Y4", "HEX6X", "OCTOX8", "OCTOFLATP", "OCTOFLATX",
-    "AIRPLANE", "HELI_120_CCPM", "HELI_90_DEG", "VTAIL4", "CUSTOM", "FW_DRAG", NULL
+    "AIRPLANE", "HELI_120_CCPM", "HELI_90_DEG", "VTAIL4", "CUSTOM", "FW_DRAG", "CUSTOM_AIRPLANE", NULL
+};
+
+// sync this with the MIXIN_ enum from mw.h
+const char * const mixerInputNames[] = {
+    "ROLL", "ROLL2", "PITCH", "YAW", "YAW+", "YAW-", "THR", "FLAP",
+    "SROLL", "SPITCH", "SYAW", "SYAW+", "SYAW-", "PYAW", "PYAW+", "PYAW-", NULL
 };
 
 // sync this with AvailableFeatures enum from board.h
 const char * const featureNames[] = {
     "PPM", "VBAT", "INFLIGHT_ACC_CAL", "SPEKTRUM", "MOTOR_STOP",
     "SERVO_TILT", "GYRO_SMOOTHING", "LED_RING", "GPS",
-    "FAILSAFE", "SONAR", "TELEMETRY",
+    "FAILSAFE", "SONAR", "TELEMETRY", "POWERMETER",
+    "GYRO_SYNC", "BLACKBOX",
     NULL
 };
 
@@ -74,7 +83,9 @@ const clicmd_t cmdTable[] = {
     { "mixer", "mixer name or list", cliMixer },
     { "save", "save and reboot", cliSave },
     { "set", "name=value or blank or * for list", cliSet },
+    { "smix", "design custom airplane servo mixer", cliSMix },
     { "status", "show system status", cliStatus },
+    { "tasks", "show task timing and load", cliTasks },
     { "version", "", cliVersion },
 };
 #define CMD_COUNT (sizeof(cmdTable) / sizeof(cmdTable[0]))
@@ -113,6 +124,8 @@ const clivalue_t valueTable[] = {
     { "motor_pwm_rate", VAR_UINT16, &cfg.motor_pwm_rate, 50, 498 },
     { "servo_pwm_rate", VAR_UINT16, &cfg.servo_pwm_rate, 50, 498 },
     { "serial_baudrate", VAR_UINT32, &cfg.serial_baudrate, 1200, 115200 },
+    { "blackbox_rate", VAR_UINT8, &cfg.blackbox_rate, 1, 32 },
+    { "telemetry_provider", VAR_UINT8, &cfg.telemetry_provider, 0, 1 },
     { "gps_baudrate", VAR_UINT32, &cfg.gps_baudrate, 1200, 115200 },
     { "spektrum_hires", VAR_UINT8, &cfg.spektrum_hires, 0, 1 },
     { "vbatscale", VAR_UINT8, &cfg.vbatscale, 10, 200 },
@@ -539,6 +552,81 @@ static void cliCMix(char *cmdline)
     }
 }
 
+static void cliSMix(char *cmdline)
+{
+    int i, j;
+    uint8_t len;
+    char buf[16];
+    char *ptr;
+    float weight;
+
+    len = strlen(cmdline);
+
+    if (len == 0) {
+        uartPrint("Custom airplane servo mixer: \r\nServo\tInput weights\r\n");
+        for (i = 0; i < MAX_SERVO_MIX; i++) {
+            printf("#%d:\t", i + 1);
+            for (j = 0; j < MIXIN_COUNT; j++) {
+                if (cfg.customServoMixer[i].weight[j])
+                    printf("%s %s  ", mixerInputNames[j], ftoa((float)cfg.customServoMixer[i].weight[j] / (1 << SERVO_MIX_SHIFT), buf));
+            }
+            uartPrint("\r\n");
+        }
+        return;
+    } else if (strncasecmp(cmdline, "reset", len) == 0) {
+        memset(cfg.customServoMixer, 0, sizeof(cfg.customServoMixer));
+        cliSMix("");
+    } else if (strncasecmp(cmdline, "load", 4) == 0) {
+        ptr = strchr(cmdline, ' ');
+        if (ptr) {
+            len = strlen(++ptr);
+            for (i = 0; ; i++) {
+                if (mixerNames[i] == NULL) {
+                    uartPrint("Invalid mixer type...\r\n");
+                    break;
+                }
+                if (strncasecmp(ptr, mixerNames[i], len) == 0) {
+                    if (servoMixerLoadMix(i)) {
+                        printf("Loaded %s mix...\r\n", mixerNames[i]);
+                        cliSMix("");
+                    } else {
+                        printf("%s has no servo mix\r\n", mixerNames[i]);
+                    }
+                    break;
+                }
+            }
+        }
+    } else {
+        ptr = cmdline;
+        i = atoi(ptr); // get servo number
+        if (--i < MAX_SERVO_MIX && i >= 0) {
+            ptr = strchr(ptr, ' ');
+            if (ptr) {
+                len = strcspn(++ptr, " ");
+                for (j = 0; j < MIXIN_COUNT; j++) {
+                    if (strlen(mixerInputNames[j]) == len && strncasecmp(ptr, mixerInputNames[j], len) == 0)
+                        break;
+                }
+                ptr = strchr(ptr, ' ');
+            }
+            if (!ptr || j == MIXIN_COUNT) {
+                uartPrint("Wrong arguments, needs servo input weight, inputs are:\r\n");
+                for (j = 0; j < MIXIN_COUNT; j++)
+                    printf("%s ", mixerInputNames[j]);
+                uartPrint("\r\n");
+            } else {
+                // weights are stored in 1/64, -2.0 to 1.98
+                weight = _atof(++ptr) * (1 << SERVO_MIX_SHIFT);
+                weight += weight < 0 ? -0.5f : 0.5f;
+                cfg.customServoMixer[i].weight[j] = constrain((int)weight, -128, 127);
+                cliSMix("");
+            }
+        } else {
+            printf("Servo number must be between 1 and %d\r\n", MAX_SERVO_MIX);
+        }
+    }
+}
+
 static void cliDefaults(char *cmdline)
 {
     uartPrint("Resetting to defaults...\r\n");
@@ -802,6 +890,7 @@ static void cliStatus(char *cmdline)
 {
     uint8_t i;
     uint32_t mask;
+    pwmInputStats_t stats;
 
     printf("System Uptime: %d seconds, Voltage: %d * 0.1V (%dS battery)\r\n",
         millis() / 1000, vbat, batteryCellCount);
@@ -819,6 +908,40 @@ static void cliStatus(char *cmdline)
     uartPrint("\r\n");
 
     printf("Cycle Time: %d, I2C Errors: %d\r\n", cycleTime, i2cGetErrorCounter());
+    printf("Annex overruns: %d, Interleave idle: %dus\r\n", annex650_overrun_count, interleaveIdleTime);
+    printf("Loop rate: %dHz, Jitter: %dus%s\r\n", loopRate, cycleJitter, gyroSync ? " (gyro sync)" : "");
+    if (feature(FEATURE_BLACKBOX))
+        printf("Blackbox dropped frames: %d\r\n", blackboxDropped);
+    if (!feature(FEATURE_SPEKTRUM)) {
+        uartPrint("RX glitches/pulses:");
+        for (i = 0; i < MAX_INPUTS; i++) {
+            pwmGetInputStats(i, &stats);
+            printf(" %d/%d", stats.glitches, stats.pulses);
+        }
+        uartPrint("\r\n");
+    }
+}
+
+static void cliTasks(char *cmdline)
+{
+    uint8_t i;
+    uint32_t window = (micros() - taskStatsStart) / 1000;
+    uint32_t load, totalLoad = 0;
+
+    if (window == 0)
+        window = 1;
+    uartPrint("Task\tPri\tPeriod\tRate\tAvg\tMax\tLoad\tMissed\r\n");
+    for (i = 0; i < TASK_COUNT; i++) {
+        if (!tasks[i].enabled)
+            continue;
+        load = tasks[i].totalTime / window;     // us per ms, so 1/1000 of the cpu
+        totalLoad += load;
+        printf("%s\t%d\t%d\t%d\t%d\t%d\t%d.%d%%\t%d\r\n", tasks[i].name, tasks[i].priority, tasks[i].period,
+            tasks[i].runs * 1000 / window, tasks[i].runs ? tasks[i].totalTime / tasks[i].runs : 0, tasks[i].maxTime,
+            load / 10, load % 10, tasks[i].missed);
+    }
+    printf("Total load %d.%d%% over the last %d ms\r\n", totalLoad / 10, totalLoad % 10, window);
+    taskStatsReset();
 }
 
 static void cliVersion(char *cmdline)
@@ -24,7 +24,7 @@
 config_t cfg;
 const char rcChannelLetters[] = "AERT1234";
 
-static uint8_t EEPROM_CONF_VERSION = 36;
+static uint8_t EEPROM_CONF_VERSION = 40;
 static uint32_t enabledSensors = 0;
 static void resetConf(void);
 
@@ -129,6 +129,37 @@ void writeParams(uint8_t b)
         blinkLED(15, 20, 1);
 }
 
+// CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) over a whole config_t
+uint16_t configCrc(const config_t *c)
+{
+    const uint8_t *p;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for (p = (const uint8_t *)c; p < ((const uint8_t *)c + sizeof(config_t)); p++) {
+        crc ^= (uint16_t)*p << 8;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+// Replace the whole configuration with a copy sent by the configurator and save it.
+// The copy must be for this config version, complete and intact, otherwise nothing changes.
+bool configApply(const config_t *c, uint8_t version, uint16_t size, uint16_t crc)
+{
+    if (version != EEPROM_CONF_VERSION || size != sizeof(config_t))
+        return false;
+    if (c->version != EEPROM_CONF_VERSION || c->size != sizeof(config_t) || c->magic_be != 0xBE || c->magic_ef != 0xEF)
+        return false;
+    if (configCrc(c) != crc)
+        return false;
+
+    memcpy(&cfg, c, sizeof(config_t));
+    writeParams(0);
+    return true;
+}
+
 void checkFirstTime(bool reset)
 {
     // check the EEPROM integrity before resetting values
@@ -282,6 +313,8 @@ static void resetConf(void)
 
     // serial (USART1) baudrate
     cfg.serial_baudrate = 115200;
+    cfg.blackbox_rate = 1;
+    cfg.telemetry_provider = TELEMETRY_FRSKY;
 
 	// Aeroplane stuff
 	cfg.flapmode = ADV_FLAP;				// Switch for flaperon mode?
@@ -306,6 +339,8 @@ static void resetConf(void)
     // custom mixer. clear by defaults.
     for (i = 0; i < MAX_MOTORS; i++)
         cfg.customMixer[i].throttle = 0.0f;
+    // custom airplane servo mix starts out as the plain airplane
+    servoMixerLoadMix(MULTITYPE_AIRPLANE - 1);
 
     writeParams(0);
 }
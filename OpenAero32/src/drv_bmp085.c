@@ -7,9 +7,13 @@ static uint16_t convOverrun = 0;
 #define BARO_OFF                 digitalLo(BARO_GPIO, BARO_PIN);
 #define BARO_ON                  digitalHi(BARO_GPIO, BARO_PIN);
 
-// EXTI14 for BMP085 End of Conversion Interrupt
+// EXTI10-15 share this vector. EXTI13 for MPU6050 data ready, EXTI14 for BMP085 End of Conversion Interrupt
 void EXTI15_10_IRQHandler(void)
 {
+    if (EXTI_GetITStatus(EXTI_Line13) == SET) {
+        EXTI_ClearITPendingBit(EXTI_Line13);
+        mpu6050DataReady();
+    }
     if (EXTI_GetITStatus(EXTI_Line14) == SET) {
         EXTI_ClearITPendingBit(EXTI_Line14);
         convDone = true;
@@ -30,6 +30,9 @@
 #define DataOutputRate_30HZ   0x05
 #define DataOutputRate_75HZ   0x06
 
+static i2cSample_t magSample;
+static uint8_t magSampleCount = 0;
+
 bool hmc5883lDetect(void)
 {
     bool ack = false;
@@ -73,6 +76,9 @@ void hmc5883lFinishCal(void)
     i2cWrite(MAG_ADDRESS, ConfigRegA, SampleAveraging_8 << 5 | DataOutputRate_75HZ << 2 | NormalOperation);
     i2cWrite(MAG_ADDRESS, ConfigRegB, magGain);
     i2cWrite(MAG_ADDRESS, ModeRegister, ContinuousConversion);
+
+    i2cSampleInit(&magSample, MAG_ADDRESS, MAG_DATA_REGISTER, 6);
+    magSampleCount = magSample.count;
 }
 
 void hmc5883lRead(int16_t *magData)
@@ -85,3 +91,22 @@ void hmc5883lRead(int16_t *magData)
     magData[1] = buf[2] << 8 | buf[3];
     magData[2] = buf[4] << 8 | buf[5];
 }
+
+// Non-blocking read for the main loop. Returns false and queues a read if there is no
+// new sample since the last call, so the caller should try again a pass later.
+bool hmc5883lReadSample(int16_t *magData)
+{
+    uint8_t *buf;
+
+    if (magSample.count == magSampleCount) {
+        i2cSampleStart(&magSample);
+        return false;
+    }
+    magSampleCount = magSample.count;
+
+    buf = i2cSampleData(&magSample);
+    magData[0] = buf[0] << 8 | buf[1];
+    magData[1] = buf[2] << 8 | buf[3];
+    magData[2] = buf[4] << 8 | buf[5];
+    return true;
+}
@@ -5,3 +5,4 @@ void hmc5883lInit(void);
 void hmc5883lCal(uint8_t calibration_gain);
 void hmc5883lFinishCal(void);
 void hmc5883lRead(int16_t *magData);
+bool hmc5883lReadSample(int16_t *magData);
@@ -46,6 +46,91 @@ static volatile uint8_t reading;
 static volatile uint8_t* write_p;
 static volatile uint8_t* read_p;
 
+// Queued sample reads. A queued sample is started by the event handler as soon as the
+// job in front of it finishes, so the bus runs back to back without the caller waiting.
+#define I2C_QUEUE_SIZE 4
+static i2cSample_t *sampleQueue[I2C_QUEUE_SIZE];
+static volatile uint8_t queueHead = 0;
+static volatile uint8_t queueTail = 0;
+static i2cSample_t *volatile currentSample = NULL;      // sample being read, NULL for blocking jobs
+
+static void i2cStartJob(void)
+{
+    if (!(I2Cx->CR2 & I2C_IT_EVT)) {        //if we are restarting the driver
+        if (!(I2Cx->CR1 & 0x0100)) {        // ensure sending a start
+            while (I2Cx->CR1 & 0x0200) { ; }               //wait for any stop to finish sending
+            I2C_GenerateSTART(I2Cx, ENABLE);        //send the start for the new job
+        }
+        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);        //allow the interrupts to fire off again
+    }
+}
+
+static void i2cStartSample(i2cSample_t *sample)
+{
+    currentSample = sample;
+    addr = sample->addr << 1;
+    reg = sample->reg;
+    writing = 0;
+    reading = 1;
+    read_p = sample->buf[sample->front ^ 1];    // fill the half nobody is reading
+    write_p = read_p;
+    bytes = sample->len;
+    busy = 1;
+    error = false;
+    i2cStartJob();
+}
+
+// Drop the sample in progress and everything queued behind it
+static void i2cFlushSamples(void)
+{
+    if (currentSample) {
+        currentSample->pending = 0;
+        currentSample = NULL;
+    }
+    while (queueTail != queueHead) {
+        sampleQueue[queueTail]->pending = 0;
+        queueTail = (queueTail + 1) % I2C_QUEUE_SIZE;
+    }
+}
+
+// Job finished: publish the sample that was read and start the next queued one
+static void i2cJobDone(void)
+{
+    i2cSample_t *next;
+
+    if (currentSample) {
+        if (!error) {
+            currentSample->front ^= 1;
+            currentSample->count++;
+        }
+        currentSample->pending = 0;
+        currentSample = NULL;
+    }
+
+    if (queueTail != queueHead) {
+        next = sampleQueue[queueTail];
+        queueTail = (queueTail + 1) % I2C_QUEUE_SIZE;
+        i2cStartSample(next);
+    } else {
+        busy = 0;
+    }
+}
+
+// Blocking calls wait for queued samples to drain before taking the bus
+static bool i2cWaitIdle(void)
+{
+    uint32_t timeout = I2C_DEFAULT_TIMEOUT * I2C_QUEUE_SIZE;
+
+    while (busy && --timeout > 0);
+    if (timeout == 0) {
+        i2cErrorCount++;
+        // reinit peripheral + clock out garbage
+        i2cInit(I2Cx);
+        return false;
+    }
+    return true;
+}
+
 static void i2c_er_handler(void)
 {
     volatile uint32_t SR1Register, SR2Register;
@@ -73,6 +158,7 @@ static void i2c_er_handler(void)
         }
     }
     I2Cx->SR1 &= ~0x0F00;       //reset all the error bits to clear the interrupt
+    i2cFlushSamples();
     busy = 0;
 }
 
@@ -82,6 +168,13 @@ bool i2cWriteBuffer(uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
     uint8_t my_data[16];
     uint32_t timeout = I2C_DEFAULT_TIMEOUT;
 
+    // too long
+    if (len_ > 16)
+        return false;
+
+    if (!i2cWaitIdle())
+        return false;
+
     addr = addr_ << 1;
     reg = reg_;
     writing = 1;
@@ -92,20 +185,10 @@ bool i2cWriteBuffer(uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
     busy = 1;
     error = false;
 
-    // too long
-    if (len_ > 16)
-        return false;
-
     for (i = 0; i < len_; i++)
         my_data[i] = data[i];
 
-    if (!(I2Cx->CR2 & I2C_IT_EVT)) {        //if we are restarting the driver
-        if (!(I2Cx->CR1 & 0x0100)) {        // ensure sending a start
-            while (I2Cx->CR1 & 0x0200) { ; }               //wait for any stop to finish sending
-            I2C_GenerateSTART(I2Cx, ENABLE);        //send the start for the new job
-        }
-        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);        //allow the interrupts to fire off again
-    }
+    i2cStartJob();
 
     while (busy && --timeout > 0);
     if (timeout == 0) {
@@ -127,6 +210,9 @@ bool i2cRead(uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
 {
     uint32_t timeout = I2C_DEFAULT_TIMEOUT;
 
+    if (!i2cWaitIdle())
+        return false;
+
     addr = addr_ << 1;
     reg = reg_;
     writing = 0;
@@ -137,13 +223,7 @@ bool i2cRead(uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
     busy = 1;
     error = false;
 
-    if (!(I2Cx->CR2 & I2C_IT_EVT)) {        //if we are restarting the driver
-        if (!(I2Cx->CR1 & 0x0100)) {        // ensure sending a start
-            while (I2Cx->CR1 & 0x0200) { ; }               //wait for any stop to finish sending
-            I2C_GenerateSTART(I2Cx, ENABLE);        //send the start for the new job
-        }
-        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);        //allow the interrupts to fire off again
-    }
+    i2cStartJob();
 
     while (busy && --timeout > 0);
     if (timeout == 0) {
@@ -256,10 +336,71 @@ void i2c_ev_handler(void)
         // I2Cx->CR1 &= ~0x0800;   //reset the POS bit so NACK applied to the current byte
         if (final_stop)  //If there is a final stop and no more jobs, bus is inactive, disable interrupts to prevent BTF
             I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, DISABLE);       //Disable EVT and ERR interrupts while bus inactive
-        busy = 0;
+        i2cJobDone();           //publish a finished sample and start the next queued one
     }
 }
 
+void i2cSampleInit(i2cSample_t *sample, uint8_t addr_, uint8_t reg_, uint8_t len)
+{
+    sample->addr = addr_;
+    sample->reg = reg_;
+    sample->len = len;
+    sample->front = 0;
+    sample->pending = 0;
+    sample->count = 0;
+
+    // prime the front half so readers have valid data before the first queued read completes
+    i2cRead(addr_, reg_, len, sample->buf[0]);
+}
+
+bool i2cSampleStart(i2cSample_t *sample)
+{
+    uint8_t next;
+
+    if (sample->pending)
+        return false;
+
+    __disable_irq();
+    if (busy) {
+        // bus in use, the event handler starts us when our turn comes
+        next = (queueHead + 1) % I2C_QUEUE_SIZE;
+        if (next == queueTail) {
+            __enable_irq();
+            return false;
+        }
+        sample->pending = 1;
+        sampleQueue[queueHead] = sample;
+        queueHead = next;
+        __enable_irq();
+        return true;
+    }
+    __enable_irq();
+
+    // bus idle, no interrupt can race us here
+    sample->pending = 1;
+    i2cStartSample(sample);
+    return true;
+}
+
+bool i2cSampleWait(i2cSample_t *sample)
+{
+    uint32_t timeout = I2C_DEFAULT_TIMEOUT * I2C_QUEUE_SIZE;
+
+    while (sample->pending && --timeout > 0);
+    if (timeout == 0) {
+        i2cErrorCount++;
+        // reinit peripheral + clock out garbage, this drops the stuck sample too
+        i2cInit(I2Cx);
+        return false;
+    }
+    return true;
+}
+
+uint8_t *i2cSampleData(i2cSample_t *sample)
+{
+    return sample->buf[sample->front];
+}
+
 void i2cInit(I2C_TypeDef *I2C)
 {
     NVIC_InitTypeDef NVIC_InitStructure;
@@ -273,6 +414,8 @@ void i2cInit(I2C_TypeDef *I2C)
     GPIO_Init(GPIOB, &GPIO_InitStructure);
 
     I2Cx = I2C;
+    i2cFlushSamples();
+    busy = 0;
 
     // clock out stuff to make sure slaves arent stuck
     i2cUnstick();
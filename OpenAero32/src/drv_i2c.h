@@ -1,7 +1,28 @@
 #pragma once
 
+#define I2C_SAMPLE_SIZE 14
+
+// Double buffered register read. i2cSampleStart() queues a read into the back half and
+// returns at once; when it completes the halves are swapped and count is incremented.
+// i2cSampleData() always returns the last complete sample without touching the bus.
+// i2cSampleWait() blocks until a queued read has landed, for readers that need it now.
+typedef struct i2cSample_t
+{
+    uint8_t addr;
+    uint8_t reg;
+    uint8_t len;
+    volatile uint8_t front;         // half of buf holding the last complete sample
+    volatile uint8_t pending;       // queued or being read
+    volatile uint8_t count;         // completed reads, lets the reader spot a new sample
+    uint8_t buf[2][I2C_SAMPLE_SIZE];
+} i2cSample_t;
+
 void i2cInit(I2C_TypeDef *I2Cx);
 bool i2cWriteBuffer(uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data);
 bool i2cWrite(uint8_t addr_, uint8_t reg, uint8_t data);
 bool i2cRead(uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf);
 uint16_t i2cGetErrorCounter(void);
+void i2cSampleInit(i2cSample_t *sample, uint8_t addr_, uint8_t reg_, uint8_t len);
+bool i2cSampleStart(i2cSample_t *sample);
+bool i2cSampleWait(i2cSample_t *sample);
+uint8_t *i2cSampleData(i2cSample_t *sample);
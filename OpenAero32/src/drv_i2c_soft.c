@@ -206,6 +206,37 @@ bool i2cRead(uint8_t addr, uint8_t reg, uint8_t len, uint8_t *buf)
     return true;
 }
 
+// No interrupt engine here, so samples are read on the spot and swapped straight away
+void i2cSampleInit(i2cSample_t *sample, uint8_t addr, uint8_t reg, uint8_t len)
+{
+    sample->addr = addr;
+    sample->reg = reg;
+    sample->len = len;
+    sample->front = 0;
+    sample->pending = 0;
+    sample->count = 0;
+    i2cRead(addr, reg, len, sample->buf[0]);
+}
+
+bool i2cSampleStart(i2cSample_t *sample)
+{
+    if (!i2cRead(sample->addr, sample->reg, sample->len, sample->buf[sample->front ^ 1]))
+        return false;
+    sample->front ^= 1;
+    sample->count++;
+    return true;
+}
+
+bool i2cSampleWait(i2cSample_t *sample)
+{
+    return true;
+}
+
+uint8_t *i2cSampleData(i2cSample_t *sample)
+{
+    return sample->buf[sample->front];
+}
+
 uint16_t i2cGetErrorCounter(void)
 {
     // TODO maybe fix this, but since this is test code, doesn't matter.
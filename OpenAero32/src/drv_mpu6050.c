@@ -135,6 +135,9 @@ static void mpu6050AccAlign(int16_t * accData);
 static void mpu6050GyroInit(void);
 static void mpu6050GyroRead(int16_t * gyroData);
 static void mpu6050GyroAlign(int16_t * gyroData);
+#ifndef MPU6050_DMP
+static void mpu6050StartRead(void);
+#endif
 
 #ifdef MPU6050_DMP
 static void mpu6050DmpInit(void);
@@ -145,6 +148,14 @@ int16_t dmpGyroData[3];
 extern uint16_t acc_1G;
 uint8_t mpuProductID = 0;
 
+#ifndef MPU6050_DMP
+// acc, temperature and gyro in one burst from ACCEL_XOUT_H, shared by both read functions
+static i2cSample_t mpuSample;
+static uint8_t mpuSampleUsed = 0;           // mpuSample.count when a reader last took the sample
+#endif
+static bool mpuSync = false;                // loop paced by the data ready interrupt
+static volatile uint8_t mpuDataReady = 0;
+
 bool mpu6050Detect(sensor_t * acc, sensor_t * gyro, uint8_t scale)
 {
     bool ack;
@@ -175,6 +186,9 @@ bool mpu6050Detect(sensor_t * acc, sensor_t * gyro, uint8_t scale)
     gyro->init = mpu6050GyroInit;
     gyro->read = mpu6050GyroRead;
     gyro->align = mpu6050GyroAlign;
+#ifndef MPU6050_DMP
+    gyro->start = mpu6050StartRead;
+#endif
 
 #ifdef MPU6050_DMP
     mpu6050DmpInit();
@@ -188,12 +202,31 @@ static void mpu6050AccInit(void)
     acc_1G = 1023;
 }
 
-static void mpu6050AccRead(int16_t *accData)
+#ifndef MPU6050_DMP
+// Queue the burst read unless an unread sample is already in hand or on its way. The
+// synced loop queues its own reads from the data ready interrupt.
+static void mpu6050StartRead(void)
+{
+    if (!mpuSync && mpuSample.count == mpuSampleUsed)
+        i2cSampleStart(&mpuSample);
+}
+
+// Collect the burst for a reader, waiting out one still on the bus so the data is never
+// older than a single transfer
+static uint8_t *mpu6050Sample(void)
 {
-    uint8_t buf[6];
+    if (!mpuSync && mpuSample.pending)
+        i2cSampleWait(&mpuSample);
+    mpuSampleUsed = mpuSample.count;
+    return i2cSampleData(&mpuSample);
+}
+#endif
 
+static void mpu6050AccRead(int16_t *accData)
+{
 #ifndef MPU6050_DMP
-    i2cRead(MPU6050_ADDRESS, MPU_RA_ACCEL_XOUT_H, 6, buf);
+    uint8_t *buf = mpu6050Sample();
+
     accData[0] = (int16_t)((buf[0] << 8) | buf[1]) / 8;
     accData[1] = (int16_t)((buf[2] << 8) | buf[3]) / 8;
     accData[2] = (int16_t)((buf[4] << 8) | buf[5]) / 8;
@@ -242,14 +275,16 @@ static void mpu6050GyroInit(void)
     } else {
         i2cWrite(MPU6050_ADDRESS, MPU_RA_ACCEL_CONFIG, 2 << 3);
     }
+
+    i2cSampleInit(&mpuSample, MPU6050_ADDRESS, MPU_RA_ACCEL_XOUT_H, 14);
 #endif
 }
 
 static void mpu6050GyroRead(int16_t * gyroData)
 {
-    uint8_t buf[6];
 #ifndef MPU6050_DMP
-    i2cRead(MPU6050_ADDRESS, MPU_RA_GYRO_XOUT_H, 6, buf);
+    uint8_t *buf = mpu6050Sample() + 8;
+
     gyroData[0] = (int16_t)((buf[0] << 8) | buf[1]) / 4;
     gyroData[1] = (int16_t)((buf[2] << 8) | buf[3]) / 4;
     gyroData[2] = (int16_t)((buf[4] << 8) | buf[5]) / 4;
@@ -268,6 +303,68 @@ static void mpu6050GyroAlign(int16_t * gyroData)
     gyroData[2] = -gyroData[2];
 }
 
+// Sensor synced loop. The chip samples at the rate closest to looptime (as fast as it
+// can if looptime is 0) and flags each sample on MPU_INT, PB13 on rev4 hardware.
+bool mpu6050SyncInit(uint16_t looptime)
+{
+#ifndef MPU6050_DMP
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    uint32_t div;
+
+    // gyro output rate is 8kHz with the DLPF off, 1kHz with it on
+    div = (MPU6050_DLPF_CFG == 0 ? 8000 : 1000) * (uint32_t)looptime / 1000000;
+    if (div > 0)
+        div--;
+    if (div > 255)
+        div = 255;
+    i2cWrite(MPU6050_ADDRESS, MPU_RA_SMPLRT_DIV, div);
+    i2cWrite(MPU6050_ADDRESS, MPU_RA_INT_ENABLE, 0x01);      //INT_ENABLE    -- DATA_RDY_EN, 50us pulse per sample
+
+    GPIO_EXTILineConfig(GPIO_PortSourceGPIOB, GPIO_PinSource13);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line13;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI15_10_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0F;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x0F;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    mpuSync = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Called from EXTI15_10_IRQHandler
+void mpu6050DataReady(void)
+{
+    mpuDataReady = 1;
+}
+
+// Queue the burst read for a sample the chip has flagged. Returns true once it has
+// landed, which is when the synced loop should run.
+bool mpu6050SyncReady(void)
+{
+#ifndef MPU6050_DMP
+    static uint8_t count = 0;
+
+    if (mpuDataReady && i2cSampleStart(&mpuSample))
+        mpuDataReady = 0;
+    if (mpuSample.count == count)
+        return false;
+    count = mpuSample.count;
+    return true;
+#else
+    return false;
+#endif
+}
+
 #ifdef MPU6050_DMP
 
 //This 3D array contains the default DMP memory bank binary that gets loaded during initialization.
@@ -3,3 +3,6 @@
 bool mpu6050Detect(sensor_t * acc, sensor_t * gyro, uint8_t scale);
 void mpu6050DmpLoop(void);
 void mpu6050DmpResetFifo(void);
+bool mpu6050SyncInit(uint16_t looptime);
+bool mpu6050SyncReady(void);
+void mpu6050DataReady(void);
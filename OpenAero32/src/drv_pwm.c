@@ -102,6 +102,8 @@ typedef struct {
     uint16_t rise;
     uint16_t fall;
     uint16_t capture;
+    volatile uint16_t *ccer;
+    uint16_t polarity;          // CCxP bit of the channel in CCER
 } pwmPortData_t;
 
 enum {
@@ -113,6 +115,7 @@ enum {
 
 static pwmPortData_t pwmPorts[MAX_PORTS];
 static uint16_t captures[MAX_INPUTS];
+static pwmInputStats_t inputStats[MAX_INPUTS];
 static pwmPortData_t *motors[MAX_MOTORS];
 static pwmPortData_t *servos[MAX_SERVOS];
 static uint8_t numMotors = 0;
@@ -263,6 +266,13 @@ static void pwmICConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t polarity)
     TIM_ICInit(tim, &TIM_ICInitStructure);
 }
 
+// Flip the capture edge of an input channel that pwmICConfig() has set up.
+// Only the CCxP bit changes, the filter, prescaler and enable stay as they are.
+static void pwmICTogglePolarity(pwmPortData_t *p)
+{
+    *p->ccer ^= p->polarity;
+}
+
 static void pwmGPIOConfig(GPIO_TypeDef *gpio, uint32_t pin, uint8_t input)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
@@ -316,6 +326,8 @@ static pwmPortData_t *pwmInConfig(uint8_t port, pwmCallbackPtr callback, uint8_t
     // set callback before configuring interrupts
     p->callback = callback;
     p->channel = channel;
+    p->ccer = &timerHardware[port].tim->CCER;
+    p->polarity = TIM_CCER_CC1P << timerHardware[port].channel;    // TIM_Channel_x is the CCER bit offset
 
     switch (timerHardware[port].channel) {
         case TIM_Channel_1:
@@ -402,8 +414,13 @@ static void ppmCallback(uint8_t port, uint16_t capture)
     if (diff > 2700) { // Per http://www.rcgroups.com/forums/showpost.php?p=21996147&postcount=3960 "So, if you use 2.5ms or higher as being the reset for the PPM stream start, you will be fine. I use 2.7ms just to be safe."
         chan = 0;
     } else {
-        if (diff > 750 && diff < 2250 && chan < 8) {   // 750 to 2250 ms is our 'valid' channel range
-            captures[chan] = diff;
+        if (chan < 8) {
+            if (diff > 750 && diff < 2250) {   // 750 to 2250 ms is our 'valid' channel range
+                captures[chan] = diff;
+                inputStats[chan].pulses++;
+            } else {
+                inputStats[chan].glitches++;
+            }
         }
         chan++;
         failsafeCnt = 0;
@@ -412,20 +429,30 @@ static void ppmCallback(uint8_t port, uint16_t capture)
 
 static void pwmCallback(uint8_t port, uint16_t capture)
 {
-    if (pwmPorts[port].state == 0) {
-        pwmPorts[port].rise = capture;
-        pwmPorts[port].state = 1;
-        pwmICConfig(timerHardware[port].tim, timerHardware[port].channel, TIM_ICPolarity_Falling);
+    pwmPortData_t *p = &pwmPorts[port];
+    pwmInputStats_t *stats = &inputStats[p->channel];
+
+    // flip the edge first, the next one can be as close as 750us
+    pwmICTogglePolarity(p);
+
+    if (p->state == 0) {
+        stats->period = capture - p->rise;
+        p->rise = capture;
+        p->state = 1;
     } else {
-        pwmPorts[port].fall = capture;
+        p->fall = capture;
         // compute capture
-        pwmPorts[port].capture = pwmPorts[port].fall - pwmPorts[port].rise;
-        captures[pwmPorts[port].channel] = pwmPorts[port].capture;
+        p->capture = p->fall - p->rise;
         // switch state
-        pwmPorts[port].state = 0;
-        pwmICConfig(timerHardware[port].tim, timerHardware[port].channel, TIM_ICPolarity_Rising);
-        // reset failsafe
-        failsafeCnt = 0;
+        p->state = 0;
+        if (p->capture > 750 && p->capture < 2250) {
+            captures[p->channel] = p->capture;
+            stats->pulses++;
+            // reset failsafe
+            failsafeCnt = 0;
+        } else {
+            stats->glitches++;
+        }
     }
 }
 
@@ -505,3 +532,8 @@ uint16_t pwmRead(uint8_t channel)
 {
     return captures[channel];
 }
+
+void pwmGetInputStats(uint8_t channel, pwmInputStats_t *stats)
+{
+    *stats = inputStats[channel];
+}
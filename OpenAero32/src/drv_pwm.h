@@ -49,4 +49,12 @@ void pwmWriteMotor(uint8_t index, uint16_t value);
 void pwmWriteServo(uint8_t index, uint16_t value);
 uint16_t pwmRead(uint8_t channel);
 
+typedef struct {
+    uint32_t pulses;            // pulses in the valid 750..2250us range
+    uint32_t glitches;          // pulses outside it, these are dropped
+    uint16_t period;            // PWM only, us between the last two rising edges
+} pwmInputStats_t;
+
+void pwmGetInputStats(uint8_t channel, pwmInputStats_t *stats);
+
 // void pwmWrite(uint8_t channel, uint16_t value);
@@ -331,4 +331,10 @@ uint16_t pwmRead(uint8_t channel)
 {
     return Inputs[channel].capture;
 }
+
+// capture statistics are not tracked on this board
+void pwmGetInputStats(uint8_t channel, pwmInputStats_t *stats)
+{
+    memset(stats, 0, sizeof(pwmInputStats_t));
+}
 #endif
@@ -12,16 +12,27 @@ uint32_t rxDMAPos = 0;
 volatile uint8_t txBuffer[UART_BUFFER_SIZE];
 uint32_t txBufferTail = 0;
 uint32_t txBufferHead = 0;
+static volatile uint32_t txBufferBusy = 0;              // start of the block DMA is sending
+static volatile uint32_t txBufferEnd = UART_BUFFER_SIZE; // wrap point, lowered when a reservation skips the end
 
 static void uartTxDMA(void)
 {
+    if (txBufferTail == txBufferEnd && txBufferHead < txBufferTail) {
+        txBufferTail = 0;
+        txBufferEnd = UART_BUFFER_SIZE;
+        if (txBufferHead == txBufferTail)
+            return;             // the next block is still being built
+    }
+
+    txBufferBusy = txBufferTail;
     DMA1_Channel4->CMAR = (uint32_t)&txBuffer[txBufferTail];
     if (txBufferHead > txBufferTail) {
         DMA1_Channel4->CNDTR = txBufferHead - txBufferTail;
         txBufferTail = txBufferHead;
     } else {
-        DMA1_Channel4->CNDTR = UART_BUFFER_SIZE - txBufferTail;
+        DMA1_Channel4->CNDTR = txBufferEnd - txBufferTail;
         txBufferTail = 0;
+        txBufferEnd = UART_BUFFER_SIZE;
     }
 
     DMA_Cmd(DMA1_Channel4, ENABLE);
@@ -104,6 +115,22 @@ void uartInit(uint32_t speed)
     USART_Cmd(USART1, ENABLE);
 }
 
+// Only the baud rate changes, the dma rings and anything queued in them are kept
+void uartChangeBaud(uint32_t speed)
+{
+    USART_InitTypeDef USART_InitStructure;
+
+    USART_Cmd(USART1, DISABLE);
+    USART_InitStructure.USART_BaudRate = speed;
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;
+    USART_InitStructure.USART_Parity = USART_Parity_No;
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+    USART_Init(USART1, &USART_InitStructure);
+    USART_Cmd(USART1, ENABLE);
+}
+
 uint16_t uartAvailable(void)
 {
     return (DMA_GetCurrDataCounter(DMA1_Channel5) != rxDMAPos) ? true : false;
@@ -148,6 +175,43 @@ void uartPrint(char *str)
         uartWrite(*(str++));
 }
 
+// Reserve len contiguous bytes at the head of the tx ring to build a message in place.
+// If they don't fit before the end of the ring the end is skipped and the block starts
+// over at 0. Returns NULL when the ring is too full; nothing is sent until uartCommit().
+uint8_t *uartReserve(uint16_t len)
+{
+    uint32_t busy;
+
+    if (!(DMA1_Channel4->CCR & 1) && txBufferHead == txBufferTail) {
+        // idle and empty, restart at the bottom so the whole ring is free
+        txBufferHead = txBufferTail = txBufferBusy = 0;
+        txBufferEnd = UART_BUFFER_SIZE;
+    }
+
+    busy = txBufferBusy;
+    if (txBufferHead < busy)
+        return (txBufferHead + len < busy) ? (uint8_t *)&txBuffer[txBufferHead] : NULL;
+    if (txBufferHead + len < UART_BUFFER_SIZE)
+        return (uint8_t *)&txBuffer[txBufferHead];
+    if (len < busy) {
+        __disable_irq();
+        txBufferEnd = txBufferHead;
+        txBufferHead = 0;
+        __enable_irq();
+        return (uint8_t *)&txBuffer[0];
+    }
+    return NULL;
+}
+
+// Queue len bytes built by uartReserve() and start DMA once for the whole block
+void uartCommit(uint16_t len)
+{
+    txBufferHead += len;
+
+    if (!(DMA1_Channel4->CCR & 1))
+        uartTxDMA();
+}
+
 /* -------------------------- UART2 (Spektrum, GPS) ----------------------------- */
 uartReceiveCallbackPtr uart2Callback = NULL;
 #define UART2_BUFFER_SIZE    128
@@ -8,6 +8,9 @@ uint8_t uartRead(void);
 uint8_t uartReadPoll(void);
 void uartWrite(uint8_t ch);
 void uartPrint(char *str);
+void uartChangeBaud(uint32_t speed);
+uint8_t *uartReserve(uint16_t len);
+void uartCommit(uint16_t len);
 
 // USART2 (GPS, Spektrum)
 void uart2Init(uint32_t speed, uartReceiveCallbackPtr func, bool rxOnly);
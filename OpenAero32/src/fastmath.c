@@ -0,0 +1,102 @@
+#include "board.h"
+
+#define FAST_PI_2       1.57079632679f
+#define FAST_2_PI       0.63661977236f
+
+// atan on [-1, 1], minimax odd polynomial
+static float atanPoly(float z)
+{
+    float z2 = z * z;
+    return z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+}
+
+float fast_atan2(float y, float x)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    float a;
+
+    if (ax == 0.0f && ay == 0.0f)
+        return 0.0f;
+
+    // keep the polynomial argument within [-1, 1]
+    if (ay <= ax) {
+        a = atanPoly(ay / ax);
+    } else {
+        a = FAST_PI_2 - atanPoly(ax / ay);
+    }
+
+    if (x < 0.0f)
+        a = M_PI - a;
+    return (y < 0.0f) ? -a : a;
+}
+
+// Abramowitz & Stegun 4.4.45
+float fast_asin(float x)
+{
+    float ax = fabsf(x);
+    float a;
+
+    if (ax > 1.0f)
+        ax = 1.0f;
+    a = FAST_PI_2 - fast_sqrt(1.0f - ax) * (1.5707288f + ax * (-0.2121144f + ax * (0.0742610f + ax * -0.0187293f)));
+    return (x < 0.0f) ? -a : a;
+}
+
+void fast_sincos(float x, float *s, float *c)
+{
+    int32_t quadrant;
+    float r, r2, sr, cr;
+
+    // reduce to r in [-pi/4, pi/4] and the quadrant it came from
+    quadrant = (int32_t)(x * FAST_2_PI + (x < 0.0f ? -0.5f : 0.5f));
+    r = x - (float)quadrant * FAST_PI_2;
+    r2 = r * r;
+
+    // Taylor series, the first dropped term is below 4e-6 on this range
+    sr = r * (1.0f - r2 * (1.0f / 6.0f - r2 * (1.0f / 120.0f - r2 * (1.0f / 5040.0f))));
+    cr = 1.0f - r2 * (0.5f - r2 * (1.0f / 24.0f - r2 * (1.0f / 720.0f)));
+
+    switch (quadrant & 3) {
+        case 0:
+            *s = sr;
+            *c = cr;
+            break;
+        case 1:
+            *s = cr;
+            *c = -sr;
+            break;
+        case 2:
+            *s = -sr;
+            *c = -cr;
+            break;
+        default:
+            *s = -cr;
+            *c = sr;
+            break;
+    }
+}
+
+// Magic constant and one tuned Newton step (Moroz et al.), about 3x more accurate
+// than the classic 0x5f3759df for the same work
+float InvSqrt(float x)
+{
+    union {
+        int32_t i;
+        float f;
+    } conv;
+    conv.f = x;
+    conv.i = 0x5F1FFFF9 - (conv.i >> 1);
+    return conv.f * 0.703952253f * (2.38924456f - x * conv.f * conv.f);
+}
+
+float fast_sqrt(float x)
+{
+    float y;
+
+    if (x <= 0.0f)
+        return 0.0f;
+    // one more Newton step on 1/sqrt, asin near +-1 needs the extra precision
+    y = InvSqrt(x);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return x * y;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Fast float approximations for the soft-float hot paths (IMU, heading, GPS navigation).
+// Maximum errors over the full input range, checked by tools/fastmath_test.c:
+//   fast_atan2   1.2e-5 rad
+//   fast_asin    7.0e-5 rad, input clamped to [-1, 1]
+//   fast_sincos  4.0e-6 for |x| <= 2pi, growing with |x| as float range reduction loses bits
+//   InvSqrt      6.6e-4 relative
+//   fast_sqrt    1.0e-6 relative, 0 for inputs <= 0
+
+float fast_atan2(float y, float x);
+float fast_asin(float x);
+void fast_sincos(float x, float *s, float *c);
+float InvSqrt(float x);
+float fast_sqrt(float x);
@@ -33,8 +33,10 @@ static const uint8_t ubloxInit[] = {
      0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x03, 0x01, 0x0F, 0x49,                                  // set STATUS MSG rate
      0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x06, 0x01, 0x12, 0x4F,                                  // set SOL MSG rate
      0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x12, 0x01, 0x1E, 0x67,                                  // set VELNED MSG rate
+     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51,                                  // set PVT MSG rate, u-blox 7 and later only
      0xB5, 0x62, 0x06, 0x16, 0x08, 0x00, 0x03, 0x07, 0x03, 0x00, 0x51, 0x08, 0x00, 0x00, 0x8A, 0x41,    // set WAAS to EGNOS
-     0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xC8, 0x00, 0x01, 0x00, 0x01, 0x00, 0xDE, 0x6A                 // set rate to 5Hz
+     0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xC8, 0x00, 0x01, 0x00, 0x01, 0x00, 0xDE, 0x6A,                // set rate to 5Hz
+     0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 0x01, 0x00, 0x7A, 0x12                 // then 10Hz, a u-blox 6 refuses it and stays at 5Hz
 };
 
 void gpsInit(uint32_t baudrate)
@@ -205,6 +207,8 @@ static void reset_PID(PID *pid)
 
 static float dTnav;             // Delta Time in milliseconds for navigation computations, updated with every good GPS read
 static int16_t actual_speed[2] = { 0, 0 };
+static int16_t receiver_speed[2];       // speed measured by the GPS itself (UBX NAV-PVT), same units as actual_speed
+static bool receiver_speed_valid = false;
 static float GPS_scaleLonDown;  // this is used to offset the shrinking longitude as we go towards the poles
 
 // The difference between the desired rate of travel and the actual rate of travel
@@ -454,9 +458,9 @@ static void GPS_distance_cm_bearing(int32_t * lat1, int32_t * lon1, int32_t * la
 {
     float dLat = *lat2 - *lat1; // difference of latitude in 1/10 000 000 degrees
     float dLon = (float) (*lon2 - *lon1) * GPS_scaleLonDown;
-    *dist = sqrtf(sq(dLat) + sq(dLon)) * 1.113195f;
+    *dist = fast_sqrt(sq(dLat) + sq(dLon)) * 1.113195f;
 
-    *bearing = 9000.0f + atan2f(-dLat, dLon) * 5729.57795f;      // Convert the output radians to 100xdeg
+    *bearing = 9000.0f + fast_atan2(-dLat, dLon) * 5729.57795f;      // Convert the output radians to 100xdeg
     if (*bearing < 0)
         *bearing += 36000;
 }
@@ -483,6 +487,14 @@ static void GPS_calc_velocity(void)
     // y_GPS_speed positve = Up
     // x_GPS_speed positve = Right
 
+    // the receiver measures velocity from doppler shift, far better than differencing positions
+    if (receiver_speed_valid) {
+        actual_speed[GPS_X] = receiver_speed[GPS_X];
+        actual_speed[GPS_Y] = receiver_speed[GPS_Y];
+        init = 0;
+        return;
+    }
+
     if (init) {
         float tmp = 1.0f / dTnav;
         actual_speed[GPS_X] = (float) (GPS_coord[LON] - last[LON]) * GPS_scaleLonDown * tmp;
@@ -559,8 +571,7 @@ static void GPS_calc_nav_rate(int max_speed)
 
     // nav_bearing includes crosstrack
     temp = (9000l - nav_bearing) * RADX100;
-    trig[GPS_X] = cosf(temp);
-    trig[GPS_Y] = sinf(temp);
+    fast_sincos(temp, &trig[GPS_Y], &trig[GPS_X]);
 
     for (axis = 0; axis < 2; axis++) {
         rate_error[axis] = (trig[axis] * max_speed) - actual_speed[axis];
@@ -583,7 +594,9 @@ static void GPS_update_crosstrack(void)
 {
     if (abs(wrap_18000(target_bearing - original_target_bearing)) < 4500) {     // If we are too far off or too close we don't do track following
         float temp = (target_bearing - original_target_bearing) * RADX100;
-        crosstrack_error = sinf(temp) * (wp_distance * CROSSTRACK_GAIN); // Meters we are off track line
+        float sin_temp, cos_temp;
+        fast_sincos(temp, &sin_temp, &cos_temp);
+        crosstrack_error = sin_temp * (wp_distance * CROSSTRACK_GAIN); // Meters we are off track line
         nav_bearing = target_bearing + constrain(crosstrack_error, -3000, 3000);
         nav_bearing = wrap_36000(nav_bearing);
     } else {
@@ -908,6 +921,41 @@ typedef struct {
     uint32_t heading_accuracy;
 } ubx_nav_velned;
 
+typedef struct {
+    uint32_t time;              // GPS msToW
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    uint8_t valid;
+    uint32_t time_accuracy;
+    int32_t time_nsec;
+    uint8_t fix_type;
+    uint8_t fix_status;
+    uint8_t fix_status2;
+    uint8_t satellites;
+    int32_t longitude;
+    int32_t latitude;
+    int32_t altitude_ellipsoid;
+    int32_t altitude_msl;
+    uint32_t horizontal_accuracy;
+    uint32_t vertical_accuracy;
+    int32_t ned_north;          // mm/s
+    int32_t ned_east;
+    int32_t ned_down;
+    int32_t speed_2d;           // mm/s
+    int32_t heading_2d;         // deg * 100000
+    uint32_t speed_accuracy;
+    uint32_t heading_accuracy;
+    uint16_t position_DOP;
+    uint8_t res[6];
+    int32_t heading_vehicle;
+    int16_t mag_declination;
+    uint16_t mag_accuracy;
+} ubx_nav_pvt;
+
 enum {
     PREAMBLE1 = 0xb5,
     PREAMBLE2 = 0x62,
@@ -919,6 +967,7 @@ enum {
     MSG_POSLLH = 0x2,
     MSG_STATUS = 0x3,
     MSG_SOL = 0x6,
+    MSG_PVT = 0x7,
     MSG_VELNED = 0x12,
     MSG_CFG_PRT = 0x00,
     MSG_CFG_RATE = 0x08,
@@ -958,6 +1007,9 @@ static bool _new_position;
 // do we have new speed information?
 static bool _new_speed;
 
+// has the receiver sent NAV-PVT? u-blox 6 doesn't have it and only sends the older messages
+static bool _pvt_seen;
+
 static uint8_t _disable_counter;
 
 // Receive buffer
@@ -966,7 +1018,8 @@ static union {
     ubx_nav_status status;
     ubx_nav_solution solution;
     ubx_nav_velned velned;
-    uint8_t bytes[64];
+    ubx_nav_pvt pvt;
+    uint8_t bytes[92];
 } _buffer;
 
 void _update_checksum(uint8_t *data, uint8_t len, uint8_t *ck_a, uint8_t *ck_b)
@@ -1043,8 +1096,30 @@ static bool GPS_UBLOX_newFrame(uint8_t data)
     return parsed;
 }
 
+// Set how often the receiver sends a NAV message on this port, 0 = never (CFG-MSG)
+static void UBLOX_set_message_rate(uint8_t msg_id, uint8_t rate)
+{
+    uint8_t msg[] = { PREAMBLE1, PREAMBLE2, CLASS_CFG, MSG_CFG_SET_RATE, 0x03, 0x00, CLASS_NAV, msg_id, rate };
+    uint8_t ck_a = 0, ck_b = 0;
+    uint8_t i;
+
+    _update_checksum(&msg[2], sizeof(msg) - 2, &ck_a, &ck_b);
+    for (i = 0; i < sizeof(msg); i++)
+        uart2Write(msg[i]);
+    uart2Write(ck_a);
+    uart2Write(ck_b);
+}
+
 static bool UBLOX_parse_gps(void)
 {
+    // NAV-PVT carries everything the older messages do. Once it turns up they are ignored,
+    // and any that still arrive are switched off so a PVT capable receiver ends up PVT only
+    if (_pvt_seen && _msg_id != MSG_PVT) {
+        if (_class == CLASS_NAV)
+            UBLOX_set_message_rate(_msg_id, 0);
+        return false;
+    }
+
     switch (_msg_id) {
     case MSG_POSLLH:
         //i2c_dataset.time                = _buffer.posllh.time;
@@ -1073,6 +1148,23 @@ static bool UBLOX_parse_gps(void)
         GPS_ground_course = (uint16_t) (_buffer.velned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
         _new_speed = true;
         break;
+    case MSG_PVT:
+        next_fix = (_buffer.pvt.fix_status & NAV_STATUS_FIX_VALID) && (_buffer.pvt.fix_type == FIX_3D);
+        f.GPS_FIX = next_fix;
+        GPS_numSat = _buffer.pvt.satellites;
+        GPS_coord[LON] = _buffer.pvt.longitude;
+        GPS_coord[LAT] = _buffer.pvt.latitude;
+        GPS_altitude = _buffer.pvt.altitude_msl / 10 / 100;    // alt in m
+        GPS_speed = _buffer.pvt.speed_2d / 10;                  // cm/s
+        GPS_ground_course = (uint16_t) (_buffer.pvt.heading_2d / 10000);       // Heading 2D deg * 100000 rescaled to deg * 10
+        // mm/s to the 1e-7 degree (about 1.113cm) per second used by the nav code
+        receiver_speed[GPS_X] = _buffer.pvt.ned_east * 100 / 1113;
+        receiver_speed[GPS_Y] = _buffer.pvt.ned_north * 100 / 1113;
+        receiver_speed_valid = next_fix;
+        _pvt_seen = true;
+        // a complete solution in one message, no need to wait for a matching position or speed
+        _new_speed = _new_position = false;
+        return true;
     default:
         return false;
     }
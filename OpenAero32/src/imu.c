@@ -5,7 +5,7 @@
 //#define INACCURATE 0		// Debug
 
 int16_t gyroADC[3], accADC[3], accSmooth[3], magADC[3];
-float accLPFVel[3];
+int32_t accLPFVel[3];          // ACC lowpass for AccZ height hold, in 1/256 LSB
 int16_t acc_25deg = 0;
 int32_t  BaroAlt;
 int32_t  EstAlt;             // in cm
@@ -13,7 +13,7 @@ int16_t  BaroPID = 0;
 int32_t  AltHold;
 int16_t  errorAltitudeI = 0;
 float magneticDeclination = 0.0f; // calculated at startup from config
-float accVelScale;
+int32_t accVelScale;           // velocity integration scale, 1/256 cm/s per LSB*us << 24
 
 // **************
 // gyro+acc IMU
@@ -22,12 +22,14 @@ int16_t gyroData[3] = { 0, 0, 0 };
 int16_t gyroZero[3] = { 0, 0, 0 };
 int16_t angle[2] = { 0, 0 };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
 
+#define INTERLEAVE_DELAY 650        // empirical, interleaving delay between 2 consecutive reads
+
 static void getEstimatedAttitude(void);
 
 void imuInit(void)
 {
     acc_25deg = acc_1G * 0.423f;
-	accVelScale = 9.80665f / acc_1G / 10000.0f;
+	accVelScale = 9.80665e-4f * 256.0f * 16777216.0f / acc_1G;
 
 #ifdef MAG
     // if mag sensor is enabled, use it
@@ -45,42 +47,61 @@ void computeIMU(void)
     int16_t gyroADCinter[3];
     static uint32_t timeInterleave = 0;
     static int16_t gyroYawSmooth = 0;
+    uint32_t timeIdle;
 
 #define GYRO_INTERLEAVE
 
+    // Nothing to do if the loop already started the burst a transfer time ago
+    Gyro_startRead();
     if (sensors(SENSOR_ACC)) {
         ACC_getADC();
         getEstimatedAttitude();
     }
 
     Gyro_getADC();
+#ifdef GYRO_INTERLEAVE
+    // the second read below collects this one, fetched while annexCode runs
+    if (!gyroSync)
+        Gyro_startRead();
+#endif
 
     for (axis = 0; axis < 3; axis++) {
 #ifdef GYRO_INTERLEAVE
         gyroADCp[axis] = gyroADC[axis];
-#else
-        gyroData[axis] = gyroADC[axis];
 #endif
+        gyroData[axis] = gyroADC[axis];
         if (!sensors(SENSOR_ACC))
             accADC[axis] = 0;
     }
     timeInterleave = micros();
     annexCode();
 #ifdef GYRO_INTERLEAVE
-    if ((micros() - timeInterleave) > 650) {
-        annex650_overrun_count++;
-    } else {
-        while ((micros() - timeInterleave) < 650);  // empirical, interleaving delay between 2 consecutive reads
-    }
+    // A synced loop already runs once per gyro sample, a second read would only repeat it
+    if (!gyroSync) {
+        // Use the rest of the interleave gap for the sensor tasks rather than spinning,
+        // starting one only while it is expected to finish before the second gyro read
+        do {
+            currentTime = micros();
+        } while ((currentTime - timeInterleave) < INTERLEAVE_DELAY && runBackgroundTask(INTERLEAVE_DELAY - (currentTime - timeInterleave), true));
+
+        if ((currentTime - timeInterleave) > INTERLEAVE_DELAY) {
+            annex650_overrun_count++;
+            interleaveIdleTime = 0;
+        } else {
+            timeIdle = currentTime;
+            while ((micros() - timeInterleave) < INTERLEAVE_DELAY);
+            interleaveIdleTime = micros() - timeIdle;
+        }
 
-    Gyro_getADC();
-    for (axis = 0; axis < 3; axis++) {
-        gyroADCinter[axis] = gyroADC[axis] + gyroADCp[axis];
-        // empirical, we take a weighted value of the current and the previous values
-        gyroData[axis] = (gyroADCinter[axis] + gyroADCprevious[axis]) / 3;
-        gyroADCprevious[axis] = gyroADCinter[axis] / 2;
-        if (!sensors(SENSOR_ACC))
-            accADC[axis] = 0;
+        Gyro_getADC();
+        for (axis = 0; axis < 3; axis++) {
+            gyroADCinter[axis] = gyroADC[axis] + gyroADCp[axis];
+            // empirical, we take a weighted value of the current and the previous values
+            gyroData[axis] = (gyroADCinter[axis] + gyroADCprevious[axis]) / 3;
+            gyroADCprevious[axis] = gyroADCinter[axis] / 2;
+            if (!sensors(SENSOR_ACC))
+                accADC[axis] = 0;
+        }
     }
 #endif
 
@@ -179,12 +200,9 @@ void rotateV(struct fp_vector *v, float *delta)
     float cosx, sinx, cosy, siny, cosz, sinz;
     float coszcosx, coszcosy, sinzcosx, coszsinx, sinzsinx;
 
-    cosx = cosf(-delta[PITCH]);
-    sinx = sinf(-delta[PITCH]);
-    cosy = cosf(delta[ROLL]);
-    siny = sinf(delta[ROLL]);
-    cosz = cosf(delta[YAW]);
-    sinz = sinf(delta[YAW]);
+    fast_sincos(-delta[PITCH], &sinx, &cosx);
+    fast_sincos(delta[ROLL], &siny, &cosy);
+    fast_sincos(delta[YAW], &sinz, &cosz);
 
     coszcosx = cosz * cosx;
     coszcosy = cosz * cosy;
@@ -211,7 +229,7 @@ void rotateV(struct fp_vector *v, float *delta)
 static int16_t _atan2f(float y, float x)
 {
     // no need for aidsy inaccurate shortcuts on a proper platform
-    return (int16_t)(atan2f(y, x) * (180.0f / M_PI * 10.0f));
+    return (int16_t)(fast_atan2(y, x) * (180.0f / M_PI * 10.0f));
 }
 
 static void getEstimatedAttitude(void)
@@ -239,7 +257,7 @@ static void getEstimatedAttitude(void)
         } else {
             accSmooth[axis] = accADC[axis];
         }
-		accLPFVel[axis] = accLPFVel[axis] * (1.0f - (1.0f / cfg.acc_lpf_for_velocity)) + accADC[axis] * (1.0f / cfg.acc_lpf_for_velocity);
+		accLPFVel[axis] += ((int32_t)accADC[axis] * 256 - accLPFVel[axis]) / cfg.acc_lpf_for_velocity;
         accMag += (int32_t)accSmooth[axis] * accSmooth[axis];
 
         if (sensors(SENSOR_MAG)) {
@@ -282,7 +300,7 @@ static void getEstimatedAttitude(void)
 #else
     // This hack removes gimbal lock (sorta) on pitch, so rolling around doesn't make pitch jump when roll reaches 90deg
     angle[ROLL] = _atan2f(EstG.V.X, EstG.V.Z);
-    angle[PITCH] = -asinf(EstG.V.Y / -sqrtf(EstG.V.X * EstG.V.X + EstG.V.Y * EstG.V.Y + EstG.V.Z * EstG.V.Z)) * (180.0f / M_PI * 10.0f);
+    angle[PITCH] = -fast_asin(EstG.V.Y / -fast_sqrt(EstG.V.X * EstG.V.X + EstG.V.Y * EstG.V.Y + EstG.V.Z * EstG.V.Z)) * (180.0f / M_PI * 10.0f);
 #endif
 
 #ifdef MAG
@@ -327,17 +345,6 @@ float applyDeadbandFloat(float value, int16_t deadband)
     return value;
 }
 
-float InvSqrt(float x)
-{
-    union {
-        int32_t i;
-        float f;
-    } conv;
-    conv.f = x;
-    conv.i = 0x5f3759df - (conv.i >> 1);
-    return 0.5f * conv.f * (3.0f - x * conv.f * conv.f);
-}
-
 int32_t isq(int32_t x)
 {
     return x * x;
@@ -349,13 +356,13 @@ void getEstimatedAltitude(void)
     static int16_t baroHistTab[BARO_TAB_SIZE_MAX];
     static int8_t baroHistIdx;
     static int32_t baroHigh;
+    static int32_t estAlt = 0;         // EstAlt in 1/256 cm
+    static int32_t velQ8 = 0;          // vertical velocity in 1/256 cm/s
+    static int32_t lastBaroAlt;
     uint32_t dTime;
     int16_t error;
-    float invG;
-    int16_t accZ;
-    static float vel = 0.0f;
-    static int32_t lastBaroAlt;
-    float baroVel;
+    int32_t gSq, gLen, accZ, baroVel, vel;
+    int32_t factor;
 
     if ((int32_t)(currentTime - deadLine) < UPDATE_INTERVAL)
         return;
@@ -371,7 +378,10 @@ void getEstimatedAltitude(void)
     if (baroHistIdx == cfg.baro_tab_size) 
         baroHistIdx = 0;
 
-    EstAlt = EstAlt * cfg.baro_noise_lpf + (baroHigh * 10.0f / (cfg.baro_tab_size - 1)) * (1.0f - cfg.baro_noise_lpf); // additional LPF to reduce baro noise
+    // additional LPF to reduce baro noise, filter factors are taken in 1/4096
+    factor = 4096 - (int32_t)(cfg.baro_noise_lpf * 4096);
+    estAlt += ((int64_t)((baroHigh * 10 / (cfg.baro_tab_size - 1)) * 256 - estAlt) * factor) >> 12;
+    EstAlt = estAlt >> 8;
 
     // P
     error = constrain(AltHold - EstAlt, -300, 300);
@@ -385,27 +395,34 @@ void getEstimatedAltitude(void)
 
     // projection of ACC vector to global Z, with 1G subtructed
     // Math: accZ = A * G / |G| - 1G
-    invG = InvSqrt(isq(EstG.V.X) + isq(EstG.V.Y) + isq(EstG.V.Z));
-    accZ = (accLPFVel[ROLL] * EstG.V.X + accLPFVel[PITCH] * EstG.V.Y + accLPFVel[YAW] * EstG.V.Z) * invG - acc_1G; 
+    // |G| follows the acc away from 1G while climbing or sinking hard. Two Newton steps from
+    // acc_1G keep it within 0.3% between 0.7G and 1.5G, where one step was up to 8% high.
+    gSq = isq(EstG.V.X) + isq(EstG.V.Y) + isq(EstG.V.Z);
+    gLen = (acc_1G + gSq / acc_1G) / 2;
+    gLen = (gLen + gSq / gLen) / 2;
+    accZ = (((accLPFVel[ROLL] + 128) >> 8) * (int32_t)EstG.V.X + ((accLPFVel[PITCH] + 128) >> 8) * (int32_t)EstG.V.Y + ((accLPFVel[YAW] + 128) >> 8) * (int32_t)EstG.V.Z) / gLen - acc_1G;
     accZ = applyDeadband16(accZ, acc_1G / cfg.accz_deadband);
     debug[0] = accZ;
 
     // Integrator - velocity, cm/sec
-    vel += accZ * accVelScale * dTime;
+    velQ8 += ((int64_t)accZ * dTime * accVelScale) >> 24;
 
-    baroVel = (EstAlt - lastBaroAlt) / (dTime / 1000000.0f);
+    // steps beyond 20m per update are clipped only to keep the product in range
+    baroVel = constrain(EstAlt - lastBaroAlt, -2000, 2000) * 1000000 / (int32_t)dTime;
     baroVel = constrain(baroVel, -300, 300); // constrain baro velocity +/- 300cm/s
-    baroVel = applyDeadbandFloat(baroVel, 10); // to reduce noise near zero
+    baroVel = applyDeadband16(baroVel, 10); // to reduce noise near zero
     lastBaroAlt = EstAlt;
     debug[1] = baroVel;
 
     // apply Complimentary Filter to keep near zero calculated velocity based on baro velocity
-    vel = vel * cfg.baro_cf + baroVel * (1.0f - cfg.baro_cf);
+    factor = 4096 - (int32_t)(cfg.baro_cf * 4096);
+    velQ8 += ((int64_t)(baroVel * 256 - velQ8) * factor) >> 12;
+    vel = (velQ8 + 128) >> 8;
     // vel = constrain(vel, -300, 300); // constrain velocity +/- 300cm/s
     debug[2] = vel;
-    // debug[3] = applyDeadbandFloat(vel, 5);
+    // debug[3] = applyDeadband16(vel, 5);
 
     // D
-    BaroPID -= constrain(cfg.D8[PIDALT] * applyDeadbandFloat(vel, 5) / 20, -150, 150);
+    BaroPID -= constrain(cfg.D8[PIDALT] * applyDeadband16(vel, 5) / 20, -150, 150);
     debug[3] = BaroPID;
 }
@@ -94,7 +94,8 @@ int main(void)
     // when using airplane/wing mixer, servo/motor outputs are remapped
     if (cfg.mixerConfiguration == MULTITYPE_AIRPLANE || 
 		cfg.mixerConfiguration == MULTITYPE_FLYING_WING ||
-		cfg.mixerConfiguration == MULTITYPE_FW_DRAG)
+		cfg.mixerConfiguration == MULTITYPE_FW_DRAG ||
+		cfg.mixerConfiguration == MULTITYPE_CUSTOM_AIRPLANE)
         pwm_params.airplane = true;
     else
         pwm_params.airplane = false;
@@ -162,6 +163,7 @@ int main(void)
     if (feature(FEATURE_VBAT))
         batteryInit();
 
+    schedulerInit();
     previousTime = micros();
 		
 		// Do wierd calibration thing
@@ -7,6 +7,8 @@ int16_t motor[MAX_MOTORS];
 int16_t servo[8] = { 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500 };
 
 static motorMixer_t currentMixer[MAX_MOTORS];
+static servoMixer_t currentServoMixer[MAX_SERVO_MIX];
+static uint8_t numberServoMix = 0;
 
 static const motorMixer_t mixerTri[] = {
     { 1.0f,  0.0f,  1.333333f,  0.0f },     // REAR
@@ -107,34 +109,62 @@ static const motorMixer_t mixerVtail4[] = {
     { 1.0f,  1.0f, -1.0f, -0.0f },          // FRONT_L
 };
 
+// Fixed wing servo mixes. Each servo is the weighted sum of the MIXIN_ inputs,
+// weights in 1/64. Rows are servo outputs from 0 up.
+static const servoMixer_t servoMixerAirplane[] = {
+    //   Roll Roll2 Pitch  Yaw  Yaw+  Yaw-   Thr  Flap SRoll SPitch SYaw SYaw+ SYaw- PYaw PYaw+ PYaw-
+    {{   64,    0,    0,    0,    0,    0,    0,   64,  -64,    0,    0,    0,    0,    0,    0,    0 }},   // Left flaperon or aileron
+    {{    0,   64,    0,    0,    0,    0,    0,  -64,  -64,    0,    0,    0,    0,    0,    0,    0 }},   // Right flaperon
+    {{    0,    0,    0,   64,    0,    0,    0,    0,    0,    0,  -64,    0,    0,    0,    0,    0 }},   // Rudder
+    {{    0,    0,   64,    0,    0,    0,    0,    0,    0,   64,    0,    0,    0,    0,    0,    0 }},   // Elevator
+    {{    0,    0,    0,    0,    0,    0,    0,   64,    0,    0,    0,    0,    0,    0,    0,    0 }},   // Flap
+};
+
+// The wing rudders have always ignored yawPIDpol, so they take the raw yaw PID
+static const servoMixer_t servoMixerFlyingWing[] = {
+    //   Roll Roll2 Pitch  Yaw  Yaw+  Yaw-   Thr  Flap SRoll SPitch SYaw SYaw+ SYaw- PYaw PYaw+ PYaw-
+    {{   32,    0,   32,    0,    0,    0,    0,    0,   64,   64,    0,    0,    0,    0,    0,    0 }},   // Left elevon
+    {{  -32,    0,   32,    0,    0,    0,    0,    0,  -64,   64,    0,    0,    0,    0,    0,    0 }},   // Right elevon
+    {{    0,    0,    0,   64,    0,    0,    0,    0,    0,    0,    0,    0,    0,  -64,    0,    0 }},   // Rudder
+};
+
+static const servoMixer_t servoMixerFwDrag[] = {
+    //   Roll Roll2 Pitch  Yaw  Yaw+  Yaw-   Thr  Flap SRoll SPitch SYaw SYaw+ SYaw- PYaw PYaw+ PYaw-
+    {{   32,    0,   32,    0,    0,    0,    0,    0,  -64,   64,    0,    0,    0,    0,    0,    0 }},   // Left elevon
+    {{  -32,    0,   32,    0,    0,    0,    0,    0,   64,   64,    0,    0,    0,    0,    0,    0 }},   // Right elevon
+    {{    0,    0,    0,    0,   64,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,  -64 }},   // Left drag rudder
+    {{    0,    0,    0,    0,    0,   64,    0,    0,    0,    0,    0,    0,    0,    0,  -64,    0 }},   // Right drag rudder
+};
+
 // Keep this synced with MultiType struct in mw.h!
 const mixer_t mixers[] = {
-//    numberMotor,useServo,motorMixer_t *motor
-    { 0, 0, NULL },                // entry 0
-    { 3, 1, mixerTri },            // MULTITYPE_TRI
-    { 4, 0, mixerQuadP },          // MULTITYPE_QUADP
-    { 4, 0, mixerQuadX },          // MULTITYPE_QUADX
-    { 2, 1, mixerBi },             // MULTITYPE_BI
-    { 0, 1, NULL },                // * MULTITYPE_GIMBAL
-    { 6, 0, mixerY6 },             // MULTITYPE_Y6
-    { 6, 0, mixerHex6P },          // MULTITYPE_HEX6
-    { 2, 1, NULL },                // * MULTITYPE_FLYING_WING
-    { 4, 0, mixerY4 },             // MULTITYPE_Y4
-    { 6, 0, mixerHex6X },          // MULTITYPE_HEX6X
-    { 8, 0, mixerOctoX8 },         // MULTITYPE_OCTOX8
-    { 8, 0, mixerOctoFlatP },      // MULTITYPE_OCTOFLATP
-    { 8, 0, mixerOctoFlatX },      // MULTITYPE_OCTOFLATX
-    { 2, 1, NULL },                // * MULTITYPE_AIRPLANE
-    { 0, 1, NULL },                // * MULTITYPE_HELI_120_CCPM
-    { 0, 1, NULL },                // * MULTITYPE_HELI_90_DEG
-    { 4, 0, mixerVtail4 },         // MULTITYPE_VTAIL4
-    { 0, 0, NULL },                // MULTITYPE_CUSTOM
-	{ 2, 1, NULL },                // * MULTITYPE_FW_DRAG
+//    numberMotor,useServo,motorMixer_t *motor,numberServoMix,servoMixer_t *servo
+    { 0, 0, NULL, 0, NULL },                        // entry 0
+    { 3, 1, mixerTri, 0, NULL },                    // MULTITYPE_TRI
+    { 4, 0, mixerQuadP, 0, NULL },                  // MULTITYPE_QUADP
+    { 4, 0, mixerQuadX, 0, NULL },                  // MULTITYPE_QUADX
+    { 2, 1, mixerBi, 0, NULL },                     // MULTITYPE_BI
+    { 0, 1, NULL, 0, NULL },                        // * MULTITYPE_GIMBAL
+    { 6, 0, mixerY6, 0, NULL },                     // MULTITYPE_Y6
+    { 6, 0, mixerHex6P, 0, NULL },                  // MULTITYPE_HEX6
+    { 2, 1, NULL, 3, servoMixerFlyingWing },        // * MULTITYPE_FLYING_WING
+    { 4, 0, mixerY4, 0, NULL },                     // MULTITYPE_Y4
+    { 6, 0, mixerHex6X, 0, NULL },                  // MULTITYPE_HEX6X
+    { 8, 0, mixerOctoX8, 0, NULL },                 // MULTITYPE_OCTOX8
+    { 8, 0, mixerOctoFlatP, 0, NULL },              // MULTITYPE_OCTOFLATP
+    { 8, 0, mixerOctoFlatX, 0, NULL },              // MULTITYPE_OCTOFLATX
+    { 2, 1, NULL, 5, servoMixerAirplane },          // * MULTITYPE_AIRPLANE
+    { 0, 1, NULL, 0, NULL },                        // * MULTITYPE_HELI_120_CCPM
+    { 0, 1, NULL, 0, NULL },                        // * MULTITYPE_HELI_90_DEG
+    { 4, 0, mixerVtail4, 0, NULL },                 // MULTITYPE_VTAIL4
+    { 0, 0, NULL, 0, NULL },                        // MULTITYPE_CUSTOM
+    { 2, 1, NULL, 4, servoMixerFwDrag },            // * MULTITYPE_FW_DRAG
+    { 2, 1, NULL, 0, NULL },                        // * MULTITYPE_CUSTOM_AIRPLANE
 };
 
 void mixerInit(void)
 {
-    int i;
+    int i, j;
 
     // enable servos for mixes that require them. note, this shifts motor counts.
     useServo = mixers[cfg.mixerConfiguration].useServo;
@@ -163,6 +193,21 @@ void mixerInit(void)
                 currentMixer[i] = mixers[cfg.mixerConfiguration].motor[i];
         }
     }
+
+    // fixed wing servo mix, the custom one drives servos up to the last row that has a weight
+    if (cfg.mixerConfiguration == MULTITYPE_CUSTOM_AIRPLANE) {
+        for (i = 0; i < MAX_SERVO_MIX; i++) {
+            currentServoMixer[i] = cfg.customServoMixer[i];
+            for (j = 0; j < MIXIN_COUNT; j++) {
+                if (cfg.customServoMixer[i].weight[j])
+                    numberServoMix = i + 1;
+            }
+        }
+    } else {
+        numberServoMix = mixers[cfg.mixerConfiguration].numberServoMix;
+        for (i = 0; i < numberServoMix; i++)
+            currentServoMixer[i] = mixers[cfg.mixerConfiguration].servo[i];
+    }
 }
 
 void mixerLoadMix(int index)
@@ -182,11 +227,36 @@ void mixerLoadMix(int index)
     }
 }
 
+// copy a fixed wing servo mix into cfg for MULTITYPE_CUSTOM_AIRPLANE, false if the mixer has none
+bool servoMixerLoadMix(int index)
+{
+    int i;
+
+    // we're 1-based
+    index++;
+    if (mixers[index].servo == NULL)
+        return false;
+
+    memset(cfg.customServoMixer, 0, sizeof(cfg.customServoMixer));
+    for (i = 0; i < mixers[index].numberServoMix; i++)
+        cfg.customServoMixer[i] = mixers[index].servo[i];
+    return true;
+}
+
 void writeServos(void)
 {
+    uint8_t i;
+
     if (!useServo)
         return;
 
+    // fixed wing mixes drive one servo per row
+    if (numberServoMix) {
+        for (i = 0; i < numberServoMix; i++)
+            pwmWriteServo(i, servo[i]);
+        return;
+    }
+
     switch (cfg.mixerConfiguration) {
         case MULTITYPE_BI:
             pwmWriteServo(0, servo[4]);
@@ -197,27 +267,6 @@ void writeServos(void)
             pwmWriteServo(0, servo[5]);
             break;
 
-        case MULTITYPE_AIRPLANE:
-            pwmWriteServo(0, servo[0]); // Left aileron
-            pwmWriteServo(1, servo[1]); // Right aileron
-            pwmWriteServo(2, servo[2]); // Rudder
-            pwmWriteServo(3, servo[3]); // Elevator
-            pwmWriteServo(4, servo[4]); // Flap
-            break;
-
-        case MULTITYPE_FW_DRAG:
-            pwmWriteServo(0, servo[0]); // Left elevon
-            pwmWriteServo(1, servo[1]); // Right elevon
-            pwmWriteServo(2, servo[2]); // Left drag rudder
-            pwmWriteServo(3, servo[3]); // Right drag rudder
-			break;
-
-        case MULTITYPE_FLYING_WING:
-            pwmWriteServo(0, servo[0]); // Left elevon
-            pwmWriteServo(1, servo[1]); // Right elevon
-			pwmWriteServo(2, servo[2]); // Rudder
-            break;	
-
         case MULTITYPE_GIMBAL:
             pwmWriteServo(0, servo[0]);
             pwmWriteServo(1, servo[1]);
@@ -253,28 +302,21 @@ void writeAllMotors(int16_t mc)
     writeMotors();
 }
 
-static void airplaneMixer(void)
+// Speed limited flap position, with the flap channel's servo reverse applied
+static int16_t flapInput(void)
 {
-	static int16_t flaperons = 0;
 	static int16_t flap = 0;
-	static int16_t left_roll = 0;
-	static int16_t right_roll = 0;
 	static int16_t slowFlaps = 0;
 	static uint8_t flapskip;
 	uint8_t speed;
 
-	// Throttle is handled separately here
-	motor[0] = rcData[THROTTLE];	  				// Send directly from RC for now
-	motor[1] = rcData[THROTTLE];	  				// Copy to motor[0] for now (not fitted to Afro-mini)
-
-	// Recover flap and aileron info
+	// Recover flap info
 	switch(cfg.flapmode)
 	{
-		// No flaperons - one aileron channel copied to both
+		// No flaperons - use RC flap channel if set
 		case BASIC_FLAP:
-			left_roll = rcCommand[ROLL];
-			right_roll = left_roll;
-			// Use RC flap channel if set
+		// Flaperons - two independant aileron channels + one flap input on cfg.flapchan
+		case ADV_FLAP:
 			if (cfg.flapchan != NOCHAN)
 			{
 				flap = rcCommand[cfg.flapchan];
@@ -285,25 +327,10 @@ static void airplaneMixer(void)
 		
 		// Flaperons - two ailerons with flaps pre-mixed in the TX
 		case PREMIXED_FLAP:
-			// Select left/right aileron channels
-			left_roll 	= rcCommand[ROLL];
-			right_roll 	= rcCommand[cfg.aileron2];
 			// Select flap signal decoded from flaperons
 			flap = rcCommand[cfg.flapchan]; 	// Get flap data
 			break;
 		
-		// Flaperons - two independant aileron channels + one flap input on cfg.flapchan
-		case ADV_FLAP:
-			left_roll = rcCommand[ROLL];
-			right_roll = rcCommand[cfg.aileron2];
-			// Ignore if no flap channel
-			if (cfg.flapchan != NOCHAN)
-			{
-				flap = rcCommand[cfg.flapchan];
-			}
-			else flap = 0;
-			break;
-		
 		default:
 			break;
 	}
@@ -338,25 +365,53 @@ static void airplaneMixer(void)
 	flapskip++;
 	if (flapskip > cfg.flapspeed) flapskip = 0;
 		
-	// Add in flap and reverse as necessary
-	flaperons = (slowFlaps * cfg.servoreverse[cfg.flapchan]);	
-
-	// Basic functions
-    servo[0] = left_roll + flaperons;     				// Left flaperon or Aileron
-    servo[1] = right_roll - flaperons; 					// Right flaperon
-    servo[2] = rcCommand[YAW];                       	// Rudder
-    servo[3] = rcCommand[PITCH];                     	// Elevator
-	servo[4] = flaperons;								// Speed-controlled flap
-
-	// Ignore if in pass-through mode
-    if (!f.PASSTHRU_MODE)
-	{
-		servo[0] -= (cfg.rollPIDpol * axisPID[ROLL]);	// Stabilised left flaperon or Aileron
-		servo[1] -= (cfg.rollPIDpol * axisPID[ROLL]); 	// Stabilised right flaperon
-		servo[2] -= (cfg.yawPIDpol * axisPID[YAW]);    	// Stabilised Rudder
-		servo[3] += (cfg.pitchPIDpol * axisPID[PITCH]); // Stabilised Elevator
-	}
-}																						 
+	// Reverse as necessary
+	if (cfg.flapchan == NOCHAN)
+		return slowFlaps;
+	return slowFlaps * cfg.servoreverse[cfg.flapchan];
+}
+
+// Fixed wing servos: every servo is the weighted sum of the same inputs, see MIXIN_ in mw.h
+static void servoMixer(void)
+{
+    int16_t input[MIXIN_COUNT];
+    int32_t sum;
+    uint8_t i, j;
+
+    input[MIXIN_ROLL] = rcCommand[ROLL];
+    input[MIXIN_ROLL2] = cfg.flapmode == BASIC_FLAP ? rcCommand[ROLL] : rcCommand[cfg.aileron2];
+    input[MIXIN_PITCH] = rcCommand[PITCH];
+    input[MIXIN_YAW] = rcCommand[YAW];
+    input[MIXIN_YAW_POS] = max(rcCommand[YAW], 0);
+    input[MIXIN_YAW_NEG] = min(rcCommand[YAW], 0);
+    input[MIXIN_THROTTLE] = rcCommand[THROTTLE];
+    input[MIXIN_FLAP] = flapInput();
+
+    // No stabilisation in pass-through mode
+    if (f.PASSTHRU_MODE) {
+        input[MIXIN_STAB_ROLL] = 0;
+        input[MIXIN_STAB_PITCH] = 0;
+        input[MIXIN_STAB_YAW] = 0;
+        input[MIXIN_PID_YAW] = 0;
+    } else {
+        input[MIXIN_STAB_ROLL] = cfg.rollPIDpol * axisPID[ROLL];
+        input[MIXIN_STAB_PITCH] = cfg.pitchPIDpol * axisPID[PITCH];
+        input[MIXIN_STAB_YAW] = cfg.yawPIDpol * axisPID[YAW];
+        input[MIXIN_PID_YAW] = axisPID[YAW];
+    }
+    input[MIXIN_STAB_YAW_POS] = max(input[MIXIN_STAB_YAW], 0);
+    input[MIXIN_STAB_YAW_NEG] = min(input[MIXIN_STAB_YAW], 0);
+    input[MIXIN_PID_YAW_POS] = max(input[MIXIN_PID_YAW], 0);
+    input[MIXIN_PID_YAW_NEG] = min(input[MIXIN_PID_YAW], 0);
+
+    // scaled once per servo, so half weights are exact: (a + b) >> 1 as before
+    for (i = 0; i < numberServoMix; i++) {
+        sum = 0;
+        for (j = 0; j < MIXIN_COUNT; j++)
+            sum += currentServoMixer[i].weight[j] * input[j];
+        servo[i] = sum >> SERVO_MIX_SHIFT;
+    }
+}
 
 void mixTable(void)
 {
@@ -368,7 +423,14 @@ void mixTable(void)
 		servo[i] = 0;
     }	
 
-    // airplane / servo mixes
+    // fixed wing frames, throttle is sent directly from RC for now
+    if (numberServoMix) {
+        motor[0] = rcData[THROTTLE];
+        motor[1] = rcData[THROTTLE];                // Copy to motor[0] for now (not fitted to Afro-mini)
+        servoMixer();
+    }
+
+    // other servo mixes
     switch (cfg.mixerConfiguration) {
         case MULTITYPE_BI:
             servo[4] = constrain(1500 + (cfg.yaw_direction * axisPID[YAW]) + axisPID[PITCH], 1020, 2000);   //LEFT
@@ -383,79 +445,6 @@ void mixTable(void)
             servo[0] = constrain(cfg.gimbal_pitch_mid + cfg.gimbal_pitch_gain * angle[PITCH] / 16 + rcCommand[PITCH], cfg.gimbal_pitch_min, cfg.gimbal_pitch_max);
             servo[1] = constrain(cfg.gimbal_roll_mid + cfg.gimbal_roll_gain * angle[ROLL] / 16 + rcCommand[ROLL], cfg.gimbal_roll_min, cfg.gimbal_roll_max);
             break;
-
-        case MULTITYPE_AIRPLANE:
-            airplaneMixer();
-            break;
-
-        case MULTITYPE_FLYING_WING:
-			// Throttle
-			motor[0] = rcData[THROTTLE];	  				// Send directly from RC for now
-			motor[1] = rcData[THROTTLE];	  				// Copy to motor[0] for now (not fitted to Afro-mini)
-
-			// Basic functions
-			servo[0] = (rcCommand[PITCH] + rcCommand[ROLL]) >> 1; 	// Left elevon
-			servo[1] = (rcCommand[PITCH] - rcCommand[ROLL]) >> 1; 	// Right elevon
-			servo[2] = rcCommand[YAW];                     			// Rudder
-		
-			// Ignore if in pass-through mode
-			if (!f.PASSTHRU_MODE)
-			{
-				// Stabilised left elevon
-				servo[0] = servo[0] + (cfg.pitchPIDpol * axisPID[PITCH]) + (cfg.rollPIDpol * axisPID[ROLL]);   
-				// Stabilised right elevon
-				servo[1] = servo[1] + (cfg.pitchPIDpol * axisPID[PITCH]) - (cfg.rollPIDpol * axisPID[ROLL]);	
-				// Stabilised Rudder
-				servo[2] -= axisPID[YAW]; 
-			}
-            break;
-
-		case MULTITYPE_FW_DRAG:
-			// Throttle
-			motor[0] = rcData[THROTTLE];	  				// Send directly from RC for now
-			motor[1] = rcData[THROTTLE];	  				// Copy to motor[0] for now (not fitted to Afro-mini)
-
-			// Basic functions
-			servo[0] = (rcCommand[PITCH] + rcCommand[ROLL]) >> 1; 	// Left elevon
-			servo[1] = (rcCommand[PITCH] - rcCommand[ROLL]) >> 1; 	// Right elevon
-		
-			if (rcCommand[YAW] >= 0)
-			{
-				servo[2] = rcCommand[YAW];                  // Left drag rudder
-			}
-			else 
-			{
-				servo[2] = 0;
-			}
-			
-			if (rcCommand[YAW] <= 0)
-			{
-				servo[3] = rcCommand[YAW];                  // Right drag rudder
-			}
-			else 
-			{
-				servo[3] = 0;
-			}
-		
-			// Ignore if in pass-through mode
-			if (!f.PASSTHRU_MODE)
-			{
-				// Stabilised left elevon
-				servo[0] = servo[0] + (cfg.pitchPIDpol * axisPID[PITCH]) - (cfg.rollPIDpol * axisPID[ROLL]);   
-				// Stabilised right elevon
-				servo[1] = servo[1] + (cfg.pitchPIDpol * axisPID[PITCH]) + (cfg.rollPIDpol * axisPID[ROLL]);	
-				
-				// Stabilised drag rudders (only for one side of movement)
-				if (axisPID[YAW] < 0)
-				{
-					servo[2] -= axisPID[YAW]; 
-				}
-				if (axisPID[YAW] > 0)
-				{
-					servo[3] -= axisPID[YAW]; 
-				}
-			}
-            break;
     }
 
     // do camstab
@@ -23,6 +23,9 @@ uint32_t currentTime = 0;
 uint32_t previousTime = 0;
 uint16_t cycleTime = 0; 
 int16_t annex650_overrun_count = 0;
+uint16_t interleaveIdleTime = 0;		// us spent waiting for the second gyro read in the last loop
+uint16_t cycleJitter = 0;				// cycleTime spread (max - min) over the last LOOP_STATS_CYCLES loops
+uint16_t loopRate = 0;					// loops per second over the same window
 int16_t telemTemperature1;      		// Gyro sensor temperature
 
 // RC
@@ -77,594 +80,726 @@ uint16_t batteryWarningVoltage;
 //************************************************************
 
 #define BREAKPOINT 1500	  // <-- make this a variable
+#define LOOP_STATS_CYCLES 256
+#define GYRO_READ_LEAD 450      // us, about one 14 byte MPU6050 burst at 400kHz
+
+static void updateLoopStats(void);
 
 //************************************************************
 // Code
 //************************************************************
 
-void loop(void)
+// Used by both the RC and the PID task
+static int16_t errorGyroI[3] = { 0, 0, 0 };
+static int16_t errorAngleI[2] = { 0, 0 };
+static int16_t initialThrottleHold;
+
+// 50Hz RC processing: failsafe, stick commands, arming, calibration and flight mode changes
+static void taskRc(void)
 {
     static uint8_t rcDelayCommand;      // this indicates the number of time (multiple of RC measurement at 50Hz) the sticks must be maintained to run or switch off motors
-    uint8_t axis, i;
-    int16_t error, errorAngle;
-    int16_t delta, deltaSum;
-    int16_t PTerm = 0, ITerm = 0, PTermACC = 0, ITermACC = 0, PTermGYRO = 0, ITermGYRO = 0, DTerm = 0;
-    static int16_t lastGyro[3] = { 0, 0, 0 };
-    static int16_t delta1[3], delta2[3];
-    static int16_t errorGyroI[3] = { 0, 0, 0 };
-    static int16_t errorAngleI[2] = { 0, 0 };
-    static uint32_t rcTime = 0;
-    static int16_t initialThrottleHold;
-    static uint32_t loopTime;
+    uint8_t i;
     uint16_t auxState = 0;
-    int16_t prop;
 
-
-    // This will return false if spektrum is disabled. shrug.
-    if (spektrumFrameComplete())
-	{
-		computeRC();
-	}
-    
-	// 50Hz RC loop
-	if ((int32_t)(currentTime - rcTime) >= 0) 
-	{ // 50Hz
-        rcTime = currentTime + 20000;
-        // TODO clean this up. computeRC should handle this check
-        if (!feature(FEATURE_SPEKTRUM))
-            computeRC();
+    // TODO clean this up. computeRC should handle this check
+    if (!feature(FEATURE_SPEKTRUM))
+        computeRC();
 
 #ifdef MAG
-		// Handle mag hold
-        if (sensors(SENSOR_MAG)) 
+	// Handle mag hold
+    if (sensors(SENSOR_MAG)) 
+	{
+        if (abs(rcCommand[YAW]) < 70 && f.MAG_MODE) 
 		{
-            if (abs(rcCommand[YAW]) < 70 && f.MAG_MODE) 
-			{
-                int16_t dif = heading - magHold;
-                if (dif <= -180)
-				{
-                    dif += 360;
-                }
-				if (dif >= +180)
-                {
-				    dif -= 360;
-                }
-				if (f.SMALL_ANGLES_25)
-                {
-					// For my system mag must increment Yaw, not decrement
-				    rcCommand[YAW] += dif * cfg.P8[PIDMAG] / 30;    // 18 deg
-				}
-            } 
-			else
+            int16_t dif = heading - magHold;
+            if (dif <= -180)
 			{
-                magHold = heading;
+                dif += 360;
+            }
+			if (dif >= +180)
+            {
+			    dif -= 360;
+            }
+			if (f.SMALL_ANGLES_25)
+            {
+				// For my system mag must increment Yaw, not decrement
+			    rcCommand[YAW] += dif * cfg.P8[PIDMAG] / 30;    // 18 deg
 			}
-        }
+        } 
+		else
+		{
+            magHold = heading;
+		}
+    }
 #endif
 
-        // Failsafe routine
-        if (feature(FEATURE_FAILSAFE)) 
-		{
-            if (failsafeCnt > (5 * cfg.failsafe_delay) && f.ARMED) 
-			{ // Stabilize, and set Throttle to specified level
-                for (i = 0; i < 3; i++)
-                {
-					rcData[i] = cfg.midrc[i];      // after specified guard time after RC signal is lost (in 0.1sec)
-                }
-				rcData[THROTTLE] = cfg.failsafe_throttle;
-                if (failsafeCnt > 5 * (cfg.failsafe_delay + cfg.failsafe_off_delay)) 
-				{  // Turn OFF motors after specified Time (in 0.1sec)
-                    f.ARMED = 0;  // This will prevent the copter to automatically rearm if failsafe shuts it down and prevents
-                    f.OK_TO_ARM = 0;        // to restart accidentely by just reconnect to the tx - you will have to switch off first to rearm
-                }
-                failsafeEvents++;
+    // Failsafe routine
+    if (feature(FEATURE_FAILSAFE)) 
+	{
+        if (failsafeCnt > (5 * cfg.failsafe_delay) && f.ARMED) 
+		{ // Stabilize, and set Throttle to specified level
+            for (i = 0; i < 3; i++)
+            {
+				rcData[i] = cfg.midrc[i];      // after specified guard time after RC signal is lost (in 0.1sec)
             }
-            if (failsafeCnt > (5 * cfg.failsafe_delay) && !f.ARMED) 
-			{  // Turn off "Ok To arm to prevent the motors from spinning after repowering the RX with low throttle and aux to arm
-                f.ARMED = 0;        // This will prevent the copter to automatically rearm if failsafe shuts it down and prevents
-                f.OK_TO_ARM = 0;    // to restart accidentely by just reconnect to the tx - you will have to switch off first to rearm
+			rcData[THROTTLE] = cfg.failsafe_throttle;
+            if (failsafeCnt > 5 * (cfg.failsafe_delay + cfg.failsafe_off_delay)) 
+			{  // Turn OFF motors after specified Time (in 0.1sec)
+                f.ARMED = 0;  // This will prevent the copter to automatically rearm if failsafe shuts it down and prevents
+                f.OK_TO_ARM = 0;        // to restart accidentely by just reconnect to the tx - you will have to switch off first to rearm
             }
-            failsafeCnt++;
+            failsafeEvents++;
+        }
+        if (failsafeCnt > (5 * cfg.failsafe_delay) && !f.ARMED) 
+		{  // Turn off "Ok To arm to prevent the motors from spinning after repowering the RX with low throttle and aux to arm
+            f.ARMED = 0;        // This will prevent the copter to automatically rearm if failsafe shuts it down and prevents
+            f.OK_TO_ARM = 0;    // to restart accidentely by just reconnect to the tx - you will have to switch off first to rearm
         }
+        failsafeCnt++;
+    }
 
-        if (rcData[THROTTLE] < cfg.mincheck) 
+    if (rcData[THROTTLE] < cfg.mincheck) 
+	{
+        errorGyroI[ROLL] = 0;
+        errorGyroI[PITCH] = 0;	// Reset I-terms
+        errorGyroI[YAW] = 0;
+        errorAngleI[ROLL] = 0;
+        errorAngleI[PITCH] = 0;
+        rcDelayCommand++;
+        if (rcData[YAW] < cfg.mincheck && rcData[PITCH] < cfg.mincheck && !f.ARMED) 
 		{
-            errorGyroI[ROLL] = 0;
-            errorGyroI[PITCH] = 0;	// Reset I-terms
-            errorGyroI[YAW] = 0;
-            errorAngleI[ROLL] = 0;
-            errorAngleI[PITCH] = 0;
-            rcDelayCommand++;
-            if (rcData[YAW] < cfg.mincheck && rcData[PITCH] < cfg.mincheck && !f.ARMED) 
+            if (rcDelayCommand == 20) 
 			{
-                if (rcDelayCommand == 20) 
+                calibratingG = 1000;
+                if (feature(FEATURE_GPS))
 				{
-                    calibratingG = 1000;
-                    if (feature(FEATURE_GPS))
-					{
-                        GPS_reset_home_position();
-					}
-                }
-            } 
-			else if (feature(FEATURE_INFLIGHT_ACC_CAL) && (!f.ARMED && rcData[YAW] < cfg.mincheck && rcData[PITCH] > cfg.maxcheck && rcData[ROLL] > cfg.maxcheck)) 
+                    GPS_reset_home_position();
+				}
+            }
+        } 
+		else if (feature(FEATURE_INFLIGHT_ACC_CAL) && (!f.ARMED && rcData[YAW] < cfg.mincheck && rcData[PITCH] > cfg.maxcheck && rcData[ROLL] > cfg.maxcheck)) 
+		{
+            if (rcDelayCommand == 20) 
 			{
-                if (rcDelayCommand == 20) 
+                if (AccInflightCalibrationMeasurementDone) 
+				{   // trigger saving into eeprom after landing
+                    AccInflightCalibrationMeasurementDone = 0;
+                    AccInflightCalibrationSavetoEEProm = 1;
+                } 
+				else 
 				{
-                    if (AccInflightCalibrationMeasurementDone) 
-					{   // trigger saving into eeprom after landing
-                        AccInflightCalibrationMeasurementDone = 0;
-                        AccInflightCalibrationSavetoEEProm = 1;
+                    AccInflightCalibrationArmed = !AccInflightCalibrationArmed;
+                    if (AccInflightCalibrationArmed) 
+					{
+                        toggleBeep = 2;
                     } 
 					else 
 					{
-                        AccInflightCalibrationArmed = !AccInflightCalibrationArmed;
-                        if (AccInflightCalibrationArmed) 
-						{
-                            toggleBeep = 2;
-                        } 
-						else 
-						{
-                            toggleBeep = 3;
-                        }
+                        toggleBeep = 3;
                     }
                 }
-            } 
-			// TODO - think of something to do with arming...
-			if (1)
-			{
-				f.ARMED = 1;
-			}
+            }
+        } 
+		// TODO - think of something to do with arming...
+		if (1)
+		{
+			f.ARMED = 1;
+		}
 /*
-			else if (cfg.activate[BOXARM] > 0) 
-			{
-                if (rcOptions[BOXARM] && f.OK_TO_ARM) 
-				{
-                    // TODO: feature(FEATURE_FAILSAFE) && failsafeCnt == 0
-                    f.ARMED = 1;
-                    headFreeModeHold = heading;
-                } 
-				else if (f.ARMED)
-				{
-                    f.ARMED = 0;
-                }
-				rcDelayCommand = 0;
-            } 
-			else if ((rcData[YAW] < cfg.mincheck || (cfg.retarded_arm == 1 && rcData[ROLL] < cfg.mincheck)) && f.ARMED) 
-			{
-                if (rcDelayCommand == 20)
-                {
-					f.ARMED = 0;  // rcDelayCommand = 20 => 20x20ms = 0.4s = time to wait for a specific RC command to be acknowledged
-            	}
-			} 
-			else if ((rcData[YAW] > cfg.maxcheck || (rcData[ROLL] > cfg.maxcheck && cfg.retarded_arm == 1)) && rcData[PITCH] < cfg.maxcheck && !f.ARMED && calibratingG == 0 && f.ACC_CALIBRATED) 
+		else if (cfg.activate[BOXARM] > 0) 
+		{
+            if (rcOptions[BOXARM] && f.OK_TO_ARM) 
 			{
-                if (rcDelayCommand == 20) 
-				{
-                    f.ARMED = 1;
-                    headFreeModeHold = heading;
-                }
+                // TODO: feature(FEATURE_FAILSAFE) && failsafeCnt == 0
+                f.ARMED = 1;
+                headFreeModeHold = heading;
             } 
-*/
-			else
+			else if (f.ARMED)
 			{
-                rcDelayCommand = 0;
+                f.ARMED = 0;
+            }
+			rcDelayCommand = 0;
+        } 
+		else if ((rcData[YAW] < cfg.mincheck || (cfg.retarded_arm == 1 && rcData[ROLL] < cfg.mincheck)) && f.ARMED) 
+		{
+            if (rcDelayCommand == 20)
+            {
+				f.ARMED = 0;  // rcDelayCommand = 20 => 20x20ms = 0.4s = time to wait for a specific RC command to be acknowledged
         	}
 		} 
-
-		// Do ACC trim adjustment
-		else if (rcData[THROTTLE] > cfg.maxcheck && !f.ARMED) 
+		else if ((rcData[YAW] > cfg.maxcheck || (rcData[ROLL] > cfg.maxcheck && cfg.retarded_arm == 1)) && rcData[PITCH] < cfg.maxcheck && !f.ARMED && calibratingG == 0 && f.ACC_CALIBRATED) 
 		{
-            if (rcData[YAW] < cfg.mincheck && rcData[PITCH] < cfg.mincheck) 
-			{   // throttle=max, yaw=left, pitch=min
-                if (rcDelayCommand == 20)
-				{
-                    calibratingA = 400;
-                }
-				rcDelayCommand++;
-            } 
-			else if (rcData[YAW] > cfg.maxcheck && rcData[PITCH] < cfg.mincheck) 
-			{    // throttle=max, yaw=right, pitch=min
-                if (rcDelayCommand == 20)
-				{
-                    f.CALIBRATE_MAG = 1;   // MAG calibration request
-                }
-				rcDelayCommand++;
-            } 
-			else if (rcData[PITCH] > cfg.maxcheck) 
+            if (rcDelayCommand == 20) 
 			{
-                cfg.angleTrim[PITCH] += 2;
-				writeParams(1);
-            } 
-			else if (rcData[PITCH] < cfg.mincheck) 
-			{
-                cfg.angleTrim[PITCH] -= 2;
-                writeParams(1);
-            } 
-			else if (rcData[ROLL] > cfg.maxcheck) 
-			{
-                cfg.angleTrim[ROLL] += 2;
-                writeParams(1);
-            } 
-			else if (rcData[ROLL] < cfg.mincheck) 
-			{
-                cfg.angleTrim[ROLL] -= 2;
-                writeParams(1);
-            } 
-			else 
-			{
-                rcDelayCommand = 0;
+                f.ARMED = 1;
+                headFreeModeHold = heading;
             }
-        }
-
-        if (feature(FEATURE_INFLIGHT_ACC_CAL)) 
+        } 
+*/
+		else
 		{
-            if (AccInflightCalibrationArmed && f.ARMED && rcData[THROTTLE] > cfg.mincheck && !rcOptions[BOXARM]) 
-			{   // Copter is airborne and you are turning it off via boxarm : start measurement
-                InflightcalibratingA = 50;
-                AccInflightCalibrationArmed = 0;
+            rcDelayCommand = 0;
+    	}
+	} 
+
+	// Do ACC trim adjustment
+	else if (rcData[THROTTLE] > cfg.maxcheck && !f.ARMED) 
+	{
+        if (rcData[YAW] < cfg.mincheck && rcData[PITCH] < cfg.mincheck) 
+		{   // throttle=max, yaw=left, pitch=min
+            if (rcDelayCommand == 20)
+			{
+                calibratingA = 400;
             }
-            if (rcOptions[BOXPASSTHRU]) 
-			{      // Use the Passthru Option to activate : Passthru = TRUE Meausrement started, Land and passtrhu = 0 measurement stored
-                if (!AccInflightCalibrationActive && !AccInflightCalibrationMeasurementDone)
-				{
-                    InflightcalibratingA = 50;
-            	}
-			} 
-			else if (AccInflightCalibrationMeasurementDone && !f.ARMED) 
+			rcDelayCommand++;
+        } 
+		else if (rcData[YAW] > cfg.maxcheck && rcData[PITCH] < cfg.mincheck) 
+		{    // throttle=max, yaw=right, pitch=min
+            if (rcDelayCommand == 20)
 			{
-                AccInflightCalibrationMeasurementDone = 0;
-                AccInflightCalibrationSavetoEEProm = 1;
+                f.CALIBRATE_MAG = 1;   // MAG calibration request
             }
-        }
-
-        // Set AUX1 to AUX4 states
-		for(i = 0; i < 4; i++)
-        {
-		    auxState |= (rcData[AUX1 + i] < 1300) << (3 * i) | 									   // Low
-						(1300 < rcData[AUX1 + i] && rcData[AUX1 + i] < 1700) << (3 * i + 1) |	   // Mid
-						(rcData[AUX1 + i] > 1700) << (3 * i + 2);								   // High
-		}
-        for(i = 0; i < CHECKBOXITEMS; i++)
+			rcDelayCommand++;
+        } 
+		else if (rcData[PITCH] > cfg.maxcheck) 
 		{
-            rcOptions[i] = (auxState & cfg.activate[i]) > 0;
-		}
-
-        // Handle stability mode change
-        if (rcOptions[BOXSTABILITY]) 
+            cfg.angleTrim[PITCH] += 2;
+			writeParams(1);
+        } 
+		else if (rcData[PITCH] < cfg.mincheck) 
 		{
-            // bumpless transfer to Level mode
-            if (!f.STABILITY_MODE) 
-			{
-                errorAngleI[ROLL] = 0;
-                errorAngleI[PITCH] = 0;
-                f.STABILITY_MODE = 1;
-            }
+            cfg.angleTrim[PITCH] -= 2;
+            writeParams(1);
         } 
-		else 
+		else if (rcData[ROLL] > cfg.maxcheck) 
 		{
-            f.STABILITY_MODE = 0;        // failsave support
-        }
-
-        // Handle autolevel mode change. Use autolevel in failsafe
-		// note: if FAILSAFE is disable, failsafeCnt > 5*FAILSAVE_DELAY is always false
-		if ((rcOptions[BOXAUTOLEVEL] || (failsafeCnt > 5 * cfg.failsafe_delay)) && (sensors(SENSOR_ACC))) 
+            cfg.angleTrim[ROLL] += 2;
+            writeParams(1);
+        } 
+		else if (rcData[ROLL] < cfg.mincheck) 
 		{
-            if (!f.AUTOLEVEL_MODE) 
-			{
-                errorAngleI[ROLL] = 0; 	 // Reset I-terms
-                errorAngleI[PITCH] = 0;
-                f.AUTOLEVEL_MODE = 1;
-            }
+            cfg.angleTrim[ROLL] -= 2;
+            writeParams(1);
         } 
 		else 
 		{
-            f.AUTOLEVEL_MODE = 0;
+            rcDelayCommand = 0;
         }
+    }
 
-        // Handle arming mode change
-		if ((rcOptions[BOXARM]) == 0)
+    if (feature(FEATURE_INFLIGHT_ACC_CAL)) 
+	{
+        if (AccInflightCalibrationArmed && f.ARMED && rcData[THROTTLE] > cfg.mincheck && !rcOptions[BOXARM]) 
+		{   // Copter is airborne and you are turning it off via boxarm : start measurement
+            InflightcalibratingA = 50;
+            AccInflightCalibrationArmed = 0;
+        }
+        if (rcOptions[BOXPASSTHRU]) 
+		{      // Use the Passthru Option to activate : Passthru = TRUE Meausrement started, Land and passtrhu = 0 measurement stored
+            if (!AccInflightCalibrationActive && !AccInflightCalibrationMeasurementDone)
+			{
+                InflightcalibratingA = 50;
+        	}
+		} 
+		else if (AccInflightCalibrationMeasurementDone && !f.ARMED) 
 		{
-            f.OK_TO_ARM = 1;
+            AccInflightCalibrationMeasurementDone = 0;
+            AccInflightCalibrationSavetoEEProm = 1;
         }
-		
-		// Set LED if in Autolevel or Stability modes
-		if (f.STABILITY_MODE || f.AUTOLEVEL_MODE) 
+    }
+
+    // Set AUX1 to AUX4 states
+	for(i = 0; i < 4; i++)
+    {
+	    auxState |= (rcData[AUX1 + i] < 1300) << (3 * i) | 									   // Low
+					(1300 < rcData[AUX1 + i] && rcData[AUX1 + i] < 1700) << (3 * i + 1) |	   // Mid
+					(rcData[AUX1 + i] > 1700) << (3 * i + 2);								   // High
+	}
+    for(i = 0; i < CHECKBOXITEMS; i++)
+	{
+        rcOptions[i] = (auxState & cfg.activate[i]) > 0;
+	}
+
+    // Handle stability mode change
+    if (rcOptions[BOXSTABILITY]) 
+	{
+        // bumpless transfer to Level mode
+        if (!f.STABILITY_MODE) 
 		{
-            LED1_ON;
-        } 
-		else 
+            errorAngleI[ROLL] = 0;
+            errorAngleI[PITCH] = 0;
+            f.STABILITY_MODE = 1;
+        }
+    } 
+	else 
+	{
+        f.STABILITY_MODE = 0;        // failsave support
+    }
+
+    // Handle autolevel mode change. Use autolevel in failsafe
+	// note: if FAILSAFE is disable, failsafeCnt > 5*FAILSAVE_DELAY is always false
+	if ((rcOptions[BOXAUTOLEVEL] || (failsafeCnt > 5 * cfg.failsafe_delay)) && (sensors(SENSOR_ACC))) 
+	{
+        if (!f.AUTOLEVEL_MODE) 
 		{
-            LED1_OFF;
+            errorAngleI[ROLL] = 0; 	 // Reset I-terms
+            errorAngleI[PITCH] = 0;
+            f.AUTOLEVEL_MODE = 1;
         }
+    } 
+	else 
+	{
+        f.AUTOLEVEL_MODE = 0;
+    }
+
+    // Handle arming mode change
+	if ((rcOptions[BOXARM]) == 0)
+	{
+        f.OK_TO_ARM = 1;
+    }
+	
+	// Set LED if in Autolevel or Stability modes
+	if (f.STABILITY_MODE || f.AUTOLEVEL_MODE) 
+	{
+        LED1_ON;
+    } 
+	else 
+	{
+        LED1_OFF;
+    }
 
-        // Handle Baro mode change
-		if (sensors(SENSOR_BARO)) 
+    // Handle Baro mode change
+	if (sensors(SENSOR_BARO)) 
+	{
+        if (rcOptions[BOXBARO]) 
 		{
-            if (rcOptions[BOXBARO]) 
-			{
-                if (!f.BARO_MODE) 
-				{
-                    f.BARO_MODE = 1;
-                    AltHold = EstAlt;
-                    initialThrottleHold = rcCommand[THROTTLE];
-                    errorAltitudeI = 0;
-                    BaroPID = 0;
-                }
-            } 
-			else
+            if (!f.BARO_MODE) 
 			{
-                f.BARO_MODE = 0;
-			}
-        }
+                f.BARO_MODE = 1;
+                AltHold = EstAlt;
+                initialThrottleHold = rcCommand[THROTTLE];
+                errorAltitudeI = 0;
+                BaroPID = 0;
+            }
+        } 
+		else
+		{
+            f.BARO_MODE = 0;
+		}
+    }
 
 #ifdef  MAG							 	
-		// Handle mag mode change
-        if (sensors(SENSOR_MAG)) 
+	// Handle mag mode change
+    if (sensors(SENSOR_MAG)) 
+	{
+        if (rcOptions[BOXMAG]) 
 		{
-            if (rcOptions[BOXMAG]) 
-			{
-                if (!f.MAG_MODE) 
-				{
-                    f.MAG_MODE = 1;
-                    magHold = heading;
-                }
-            } 
-			else
-			{
-                f.MAG_MODE = 0;
-			}
-            if (rcOptions[BOXHEADADJ]) 
+            if (!f.MAG_MODE) 
 			{
-                headFreeModeHold = heading; // acquire new heading
+                f.MAG_MODE = 1;
+                magHold = heading;
             }
+        } 
+		else
+		{
+            f.MAG_MODE = 0;
+		}
+        if (rcOptions[BOXHEADADJ]) 
+		{
+            headFreeModeHold = heading; // acquire new heading
         }
+    }
 #endif
-		// Handle GPS navigation mode change
-        if (sensors(SENSOR_GPS)) 
+	// Handle GPS navigation mode change
+    if (sensors(SENSOR_GPS)) 
+	{
+        if (f.GPS_FIX && GPS_numSat >= 5) 
 		{
-            if (f.GPS_FIX && GPS_numSat >= 5) 
+            if (rcOptions[BOXGPSHOME]) 
 			{
-                if (rcOptions[BOXGPSHOME]) 
-				{
-                    if (!f.GPS_HOME_MODE) 
-					{
-                        f.GPS_HOME_MODE = 1;
-                        GPS_set_next_wp(&GPS_home[LAT], &GPS_home[LON]);
-                        nav_mode = NAV_MODE_WP;
-                    }
-                } 
-				else 
+                if (!f.GPS_HOME_MODE) 
 				{
-                    f.GPS_HOME_MODE = 0;
+                    f.GPS_HOME_MODE = 1;
+                    GPS_set_next_wp(&GPS_home[LAT], &GPS_home[LON]);
+                    nav_mode = NAV_MODE_WP;
                 }
-                if (rcOptions[BOXGPSHOLD]) 
-				{
-                    if (!f.GPS_HOLD_MODE) 
-					{
-                        f.GPS_HOLD_MODE = 1;
-                        GPS_hold[LAT] = GPS_coord[LAT];
-                        GPS_hold[LON] = GPS_coord[LON];
-                        GPS_set_next_wp(&GPS_hold[LAT], &GPS_hold[LON]);
-                        nav_mode = NAV_MODE_POSHOLD;
-                    }
-                } 
-				else 
+            } 
+			else 
+			{
+                f.GPS_HOME_MODE = 0;
+            }
+            if (rcOptions[BOXGPSHOLD]) 
+			{
+                if (!f.GPS_HOLD_MODE) 
 				{
-                    f.GPS_HOLD_MODE = 0;
+                    f.GPS_HOLD_MODE = 1;
+                    GPS_hold[LAT] = GPS_coord[LAT];
+                    GPS_hold[LON] = GPS_coord[LON];
+                    GPS_set_next_wp(&GPS_hold[LAT], &GPS_hold[LON]);
+                    nav_mode = NAV_MODE_POSHOLD;
                 }
+            } 
+			else 
+			{
+                f.GPS_HOLD_MODE = 0;
             }
         }
+    }
 
-        // Handle pass-through mode change
-		if (rcOptions[BOXPASSTHRU]) 
-		{
-            f.PASSTHRU_MODE = 1;
-        } 
-		else 
-		{
-            f.PASSTHRU_MODE = 0;
-        }
-        
-    } // 50Hz loop
-	
-	
-	// Full-speed loop but not RC
+    // Handle pass-through mode change
+	if (rcOptions[BOXPASSTHRU]) 
+	{
+        f.PASSTHRU_MODE = 1;
+    } 
 	else 
-	{                    // not in rc loop
-        static int8_t taskOrder = 0;    // never call all function in the same loop, to avoid high delay spikes
-        switch (taskOrder++ % 4) 
-		{
-        case 0:
-#ifdef MAG
-            if (sensors(SENSOR_MAG))
-                Mag_getADC();
-#endif
-            break;
-        case 1:
-            if (sensors(SENSOR_BARO))
-                Baro_update();
-            break;
-        case 2:
-            if (sensors(SENSOR_BARO))
-                getEstimatedAltitude();
-            break;
-        case 3:
-            break;
-        default:
-            taskOrder = 0;
-            break;
-        }
+	{
+        f.PASSTHRU_MODE = 0;
     }
+}
 
-	// Full-speed loop
-
-	// Do IMU etc if due
-	currentTime = micros();
-    if (cfg.looptime == 0 || (int32_t)(currentTime - loopTime) >= 0) 
-	{
-        loopTime = currentTime + cfg.looptime;
+// Attitude, PID and mixer, once per gyro sample or looptime
+static void taskPid(void)
+{
+    uint8_t axis;
+    int16_t error, errorAngle;
+    int16_t delta, deltaSum;
+    int16_t PTerm = 0, ITerm = 0, PTermACC = 0, ITermACC = 0, PTermGYRO = 0, ITermGYRO = 0, DTerm = 0;
+    static int16_t lastGyro[3] = { 0, 0, 0 };
+    static int16_t delta1[3], delta2[3];
+    int16_t prop;
 
-        computeIMU();
-        // Measure loop rate just afer reading the sensors
-        currentTime = micros();
-        cycleTime = (int32_t)(currentTime - previousTime);
-        previousTime = currentTime;
+    computeIMU();
+    // Measure loop rate just afer reading the sensors
+    currentTime = micros();
+    cycleTime = (int32_t)(currentTime - previousTime);
+    previousTime = currentTime;
+    updateLoopStats();
 #ifdef MPU6050_DMP
-        mpu6050DmpLoop();
+    mpu6050DmpLoop();
 #endif
 /*
 #ifdef MAG
-		// Handle mag hold
-        if (sensors(SENSOR_MAG)) 
+	// Handle mag hold
+    if (sensors(SENSOR_MAG)) 
+	{
+        if (abs(rcCommand[YAW]) < 70 && f.MAG_MODE) 
 		{
-            if (abs(rcCommand[YAW]) < 70 && f.MAG_MODE) 
-			{
-                int16_t dif = heading - magHold;
-                if (dif <= -180)
-				{
-                    dif += 360;
-                }
-				if (dif >= +180)
-                {
-				    dif -= 360;
-                }
-				if (f.SMALL_ANGLES_25)
-                {
-				    rcCommand[YAW] -= dif * cfg.P8[PIDMAG] / 30;    // 18 deg
-				}
-            } 
-			else
+            int16_t dif = heading - magHold;
+            if (dif <= -180)
 			{
-                magHold = heading;
+                dif += 360;
+            }
+			if (dif >= +180)
+            {
+			    dif -= 360;
+            }
+			if (f.SMALL_ANGLES_25)
+            {
+			    rcCommand[YAW] -= dif * cfg.P8[PIDMAG] / 30;    // 18 deg
 			}
-        }
+        } 
+		else
+		{
+            magHold = heading;
+		}
+    }
 #endif
 */
-		// Do alt hold	   <-- but for aeroplanes
-        if (sensors(SENSOR_BARO)) 
+	// Do alt hold	   <-- but for aeroplanes
+    if (sensors(SENSOR_BARO)) 
+	{
+        if (f.BARO_MODE) 
 		{
-            if (f.BARO_MODE) 
+            if (abs(rcCommand[THROTTLE] - initialThrottleHold) > cfg.alt_hold_throttle_neutral) 
 			{
-                if (abs(rcCommand[THROTTLE] - initialThrottleHold) > cfg.alt_hold_throttle_neutral) 
-				{
-					f.BARO_MODE = 0;   // so that a new althold reference is defined
-                }
-				rcCommand[THROTTLE] = initialThrottleHold + BaroPID; //TODO - check usage of throttle zero
+				f.BARO_MODE = 0;   // so that a new althold reference is defined
             }
+			rcCommand[THROTTLE] = initialThrottleHold + BaroPID; //TODO - check usage of throttle zero
         }
-		
-		// Do GPS navigation 	   <-- but for aeroplanes
-        if (sensors(SENSOR_GPS)) 
+    }
+	
+	// Do GPS navigation 	   <-- but for aeroplanes
+    if (sensors(SENSOR_GPS)) 
+	{
+        // Check that we really need to navigate ?
+        if ((!f.GPS_HOME_MODE && !f.GPS_HOLD_MODE) || !f.GPS_FIX_HOME) 
+		{
+            // If not. Reset nav loops and all nav related parameters
+            GPS_reset_nav();
+        } 
+		else 
 		{
-            // Check that we really need to navigate ?
-            if ((!f.GPS_HOME_MODE && !f.GPS_HOLD_MODE) || !f.GPS_FIX_HOME) 
+            float sin_yaw_y, cos_yaw_x;
+            fast_sincos(heading * 0.0174532925f, &sin_yaw_y, &cos_yaw_x);
+            if (cfg.nav_slew_rate) 
 			{
-                // If not. Reset nav loops and all nav related parameters
-                GPS_reset_nav();
+                nav_rated[LON] += constrain(wrap_18000(nav[LON] - nav_rated[LON]), -cfg.nav_slew_rate, cfg.nav_slew_rate); // TODO check this on uint8
+                nav_rated[LAT] += constrain(wrap_18000(nav[LAT] - nav_rated[LAT]), -cfg.nav_slew_rate, cfg.nav_slew_rate);
+                GPS_angle[ROLL] = (nav_rated[LON] * cos_yaw_x - nav_rated[LAT] * sin_yaw_y) / 10;
+                GPS_angle[PITCH] = (nav_rated[LON] * sin_yaw_y + nav_rated[LAT] * cos_yaw_x) / 10;
             } 
 			else 
 			{
-                float sin_yaw_y = sinf(heading * 0.0174532925f);
-                float cos_yaw_x = cosf(heading * 0.0174532925f);
-                if (cfg.nav_slew_rate) 
-				{
-                    nav_rated[LON] += constrain(wrap_18000(nav[LON] - nav_rated[LON]), -cfg.nav_slew_rate, cfg.nav_slew_rate); // TODO check this on uint8
-                    nav_rated[LAT] += constrain(wrap_18000(nav[LAT] - nav_rated[LAT]), -cfg.nav_slew_rate, cfg.nav_slew_rate);
-                    GPS_angle[ROLL] = (nav_rated[LON] * cos_yaw_x - nav_rated[LAT] * sin_yaw_y) / 10;
-                    GPS_angle[PITCH] = (nav_rated[LON] * sin_yaw_y + nav_rated[LAT] * cos_yaw_x) / 10;
-                } 
-				else 
-				{
-                    GPS_angle[ROLL] = (nav[LON] * cos_yaw_x - nav[LAT] * sin_yaw_y) / 10;
-                    GPS_angle[PITCH] = (nav[LON] * sin_yaw_y + nav[LAT] * cos_yaw_x) / 10;
-                }
+                GPS_angle[ROLL] = (nav[LON] * cos_yaw_x - nav[LAT] * sin_yaw_y) / 10;
+                GPS_angle[PITCH] = (nav[LON] * sin_yaw_y + nav[LAT] * cos_yaw_x) / 10;
             }
         }
-		
-		// Measure size of largest command input
-        prop = max(abs(rcCommand[PITCH]), abs(rcCommand[ROLL])); // range [0;500]
-		
-		//*********************************************************************
-		//* Flight PITCH & ROLL & YAW PID
-		//********************************************************************/
-		
-        for (axis = 0; axis < 3; axis++) 
-		{
-            // Roll/Pitch accelerometers
-			if (f.AUTOLEVEL_MODE && axis < 2) 
-			{ 
-                // Error
-                errorAngle = constrain(GPS_angle[axis] - rcCommand[axis], -500, +500) - angle[axis] + cfg.angleTrim[axis]; // 50 degrees max inclination	    
+    }
+	
+	// Measure size of largest command input
+    prop = max(abs(rcCommand[PITCH]), abs(rcCommand[ROLL])); // range [0;500]
+	
+	//*********************************************************************
+	//* Flight PITCH & ROLL & YAW PID
+	//********************************************************************/
+	
+    for (axis = 0; axis < 3; axis++) 
+	{
+        // Roll/Pitch accelerometers
+		if (f.AUTOLEVEL_MODE && axis < 2) 
+		{ 
+            // Error
+            errorAngle = constrain(GPS_angle[axis] - rcCommand[axis], -500, +500) - angle[axis] + cfg.angleTrim[axis]; // 50 degrees max inclination	    
+
+			// P-term
+            PTermACC = (int32_t)errorAngle * cfg.P8[PIDLEVEL] / 100; // 32 bits is needed for calculation
+            PTermACC = constrain(PTermACC, -cfg.D8[PIDLEVEL] * 5, +cfg.D8[PIDLEVEL] * 5);	  // Limit the acc throw with the D variable <-- fix this bullshit 
+
+            // I-term
+			errorAngleI[axis] = constrain(errorAngleI[axis] + errorAngle, -10000, +10000); // Anti wind-up
+            ITermACC = ((int32_t)errorAngleI[axis] * cfg.I8[PIDLEVEL]) >> 12;
+        }
 
-				// P-term
-                PTermACC = (int32_t)errorAngle * cfg.P8[PIDLEVEL] / 100; // 32 bits is needed for calculation
-                PTermACC = constrain(PTermACC, -cfg.D8[PIDLEVEL] * 5, +cfg.D8[PIDLEVEL] * 5);	  // Limit the acc throw with the D variable <-- fix this bullshit 
+        // RPY Gyros in stability mode
+		if (f.STABILITY_MODE) 
+		{ 
+			// Error
+            error = (int32_t)rcCommand[axis] * 10 * 8 / cfg.P8[axis];
+            error -= gyroData[axis];
 
-                // I-term
-				errorAngleI[axis] = constrain(errorAngleI[axis] + errorAngle, -10000, +10000); // Anti wind-up
-                ITermACC = ((int32_t)errorAngleI[axis] * cfg.I8[PIDLEVEL]) >> 12;
-            }
+            // P-term
+            // Add in throttle-based Dynamic P for gyro on all axis
+			PTermGYRO -= (int32_t)gyroData[axis] * dynP8[axis] / 10 / 8; // 32 bits is needed for calculation
 
-            // RPY Gyros in stability mode
-			if (f.STABILITY_MODE) 
+            // I-term
+			errorGyroI[axis] = constrain(errorGyroI[axis] + error, -16000, +16000); // Anti wind-up
+            if (abs(gyroData[axis]) > 640)
 			{ 
-				// Error
-                error = (int32_t)rcCommand[axis] * 10 * 8 / cfg.P8[axis];
-                error -= gyroData[axis];
-
-                // P-term
-	            // Add in throttle-based Dynamic P for gyro on all axis
-				PTermGYRO -= (int32_t)gyroData[axis] * dynP8[axis] / 10 / 8; // 32 bits is needed for calculation
-
-                // I-term
-				errorGyroI[axis] = constrain(errorGyroI[axis] + error, -16000, +16000); // Anti wind-up
-                if (abs(gyroData[axis]) > 640)
-				{ 
-                    errorGyroI[axis] = 0;		 // Trash the I-term if gyro data bottoms out
-                }
-				ITermGYRO = (errorGyroI[axis] / 125 * cfg.I8[axis]) >> 6;
-
-	              // D-term for all axis
-				delta = gyroData[axis] - lastGyro[axis]; // 16 bits is ok here, the dif between 2 consecutive gyro reads is limited to 800
-	            lastGyro[axis] = gyroData[axis];
-	            deltaSum = delta1[axis] + delta2[axis] + delta;
-	            delta2[axis] = delta1[axis];
-	            delta1[axis] = delta;
-	            DTerm = ((int32_t)deltaSum * dynD8[axis]) >> 5; // 32 bits is needed for calculation
+                errorGyroI[axis] = 0;		 // Trash the I-term if gyro data bottoms out
             }
+			ITermGYRO = (errorGyroI[axis] / 125 * cfg.I8[axis]) >> 6;
+
+              // D-term for all axis
+			delta = gyroData[axis] - lastGyro[axis]; // 16 bits is ok here, the dif between 2 consecutive gyro reads is limited to 800
+            lastGyro[axis] = gyroData[axis];
+            deltaSum = delta1[axis] + delta2[axis] + delta;
+            delta2[axis] = delta1[axis];
+            delta1[axis] = delta;
+            DTerm = ((int32_t)deltaSum * dynD8[axis]) >> 5; // 32 bits is needed for calculation
+        }
 
-			// Dynamically vary the Roll/Pitch ACC and Gyro mix depending on the RC input (Autolevel+Stability mode)
-            if (f.AUTOLEVEL_MODE && f.STABILITY_MODE && axis < 2) 
-			{
-                PTerm = ((int32_t)PTermACC * (500 - prop) + (int32_t)PTermGYRO * prop) / 500;
-                ITerm = ((int32_t)ITermACC * (500 - prop) + (int32_t)ITermGYRO * prop) / 500;
-            } 
+		// Dynamically vary the Roll/Pitch ACC and Gyro mix depending on the RC input (Autolevel+Stability mode)
+        if (f.AUTOLEVEL_MODE && f.STABILITY_MODE && axis < 2) 
+		{
+            PTerm = ((int32_t)PTermACC * (500 - prop) + (int32_t)PTermGYRO * prop) / 500;
+            ITerm = ((int32_t)ITermACC * (500 - prop) + (int32_t)ITermGYRO * prop) / 500;
+        } 
 
-			// Use accelerometers in Autolevel-only mode
-            else if (f.AUTOLEVEL_MODE && !f.STABILITY_MODE && axis < 2) 
-			{
-                PTerm = PTermACC;
-                ITerm = ITermACC;
-            } 
+		// Use accelerometers in Autolevel-only mode
+        else if (f.AUTOLEVEL_MODE && !f.STABILITY_MODE && axis < 2) 
+		{
+            PTerm = PTermACC;
+            ITerm = ITermACC;
+        } 
 
-			// Not in Autolevel so use gyros only (also for Yaw axis)
-			else 
-			{
-                PTerm = PTermGYRO;
-                ITerm = ITermGYRO;
-            }
-																								   
+		// Not in Autolevel so use gyros only (also for Yaw axis)
+		else 
+		{
+            PTerm = PTermGYRO;
+            ITerm = ITermGYRO;
+        }
+																							   
  			// PID sum
-            axisPID[axis] =  PTerm + ITerm - DTerm;
-			PTermGYRO = 0; //debug
-			PTerm = 0; // Debug
-			ITerm = 0; // Debug
-			DTerm = 0; // Debug
+        axisPID[axis] =  PTerm + ITerm - DTerm;
+		PTermGYRO = 0; //debug
+		PTerm = 0; // Debug
+		ITerm = 0; // Debug
+		DTerm = 0; // Debug
+    }
+
+    mixTable();
+    writeServos();
+    writeMotors();
+    // a free running loop comes straight back, fetch the next sample behind the background task
+    if (!gyroSync && cfg.looptime == 0)
+        Gyro_startRead();
+    blackboxUpdate();
+}
+
+static void taskMag(void)
+{
+#ifdef MAG
+    Mag_getADC();
+#endif
+}
+
+//************************************************************
+// Scheduler
+//************************************************************
+
+// Background periods are polling rates. Baro and mag keep their own sensor deadlines,
+// polling them faster only picks up a finished conversion or transfer sooner.
+// Only the sensor tasks may run inside taskPid, in the gyro interleave gap; RC handling
+// arms, calibrates and writes the config, and serial can run the CLI. Their first time
+// estimates are worst cases, so an untimed task never counts as fitting a small gap.
+task_t tasks[TASK_COUNT] = {
+    { "PID",      taskPid,              TASK_PRIORITY_REALTIME, 0,     true,  false, 0 },
+    { "RC",       taskRc,               TASK_PRIORITY_HIGH,     20000, true,  false, 1000 },
+    { "BARO",     Baro_update,          TASK_PRIORITY_MEDIUM,   2000,  false, true,  250 },
+    { "ALTITUDE", getEstimatedAltitude, TASK_PRIORITY_MEDIUM,   25000, false, true,  250 },
+    { "MAG",      taskMag,              TASK_PRIORITY_MEDIUM,   10000, false, true,  250 },
+    { "SERIAL",   serialCom,            TASK_PRIORITY_LOW,      2000,  true,  false, 1000 },
+};
+uint32_t taskStatsStart = 0;
+static uint32_t nestedTime = 0;     // time of tasks run from inside the running one
+
+void schedulerInit(void)
+{
+    uint8_t i;
+
+    tasks[TASK_PID].period = gyroSync ? 0 : cfg.looptime;
+    tasks[TASK_BARO].enabled = sensors(SENSOR_BARO);
+    tasks[TASK_ALTITUDE].enabled = sensors(SENSOR_BARO);
+#ifdef MAG
+    tasks[TASK_MAG].enabled = sensors(SENSOR_MAG);
+#endif
+    for (i = 0; i < TASK_COUNT; i++)
+        tasks[i].due = micros();
+    taskStatsReset();
+}
+
+void taskStatsReset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < TASK_COUNT; i++) {
+        tasks[i].maxTime = 0;
+        tasks[i].totalTime = 0;
+        tasks[i].runs = 0;
+        tasks[i].missed = 0;
+    }
+    taskStatsStart = micros();
+}
+
+static void runTask(task_t *task)
+{
+    uint32_t start, elapsed, outerNested = nestedTime;
+
+    currentTime = start = micros();
+    if (task->period && (int32_t)(currentTime - task->due) >= (int32_t)task->period)
+        task->missed++;
+    if (task == &tasks[TASK_PID]) {
+        task->due = currentTime + task->period;
+    } else {
+        task->due += task->period;
+        if ((int32_t)(currentTime - task->due) >= 0)   // fell behind, don't try to catch up
+            task->due = currentTime + task->period;
+    }
+
+    nestedTime = 0;
+    task->func();
+    elapsed = micros() - start;
+    outerNested += elapsed;
+    elapsed -= nestedTime;
+    nestedTime = outerNested;
+
+    task->runs++;
+    task->totalTime += elapsed;
+    if (elapsed > task->maxTime)
+        task->maxTime = elapsed;
+    // what the task is expected to take: follows spikes at once, forgets them slowly
+    if (elapsed > task->estTime)
+        task->estTime = elapsed;
+    else
+        task->estTime -= (task->estTime - elapsed) >> 4;
+}
+
+// Run the most urgent due background task that is expected to finish within slack us.
+// From the main loop a task that is already a whole period late runs anyway, so none
+// starve. From the interleave gap only interleave tasks run, and only if they fit.
+bool runBackgroundTask(uint32_t slack, bool interleave)
+{
+    task_t *task, *best = NULL;
+    bool late, bestLate = false;
+
+    currentTime = micros();
+    for (task = &tasks[TASK_PID + 1]; task < &tasks[TASK_COUNT]; task++) {
+        if (!task->enabled || (interleave && !task->interleave) || (int32_t)(currentTime - task->due) < 0)
+            continue;
+        late = !interleave && (int32_t)(currentTime - task->due) >= (int32_t)task->period;
+        if (!late && task->estTime > slack)
+            continue;
+        if (!best || late > bestLate || (late == bestLate && task->priority < best->priority)) {
+            best = task;
+            bestLate = late;
         }
+    }
+
+    if (!best)
+        return false;
+    runTask(best);
+    return true;
+}
+
+void loop(void)
+{
+    uint32_t slack;
+
+    // This will return false if spektrum is disabled. shrug.
+    if (spektrumFrameComplete())
+        computeRC();
+
+    // The PID task goes first, on our own clock or when the gyro has a new sample. Its
+    // gyro burst is started one transfer ahead so computeIMU() doesn't have to wait on it.
+    currentTime = micros();
+    if (!gyroSync && cfg.looptime && (int32_t)(tasks[TASK_PID].due - currentTime) <= GYRO_READ_LEAD)
+        Gyro_startRead();
+    if (gyroSync ? mpu6050SyncReady() : cfg.looptime == 0 || (int32_t)(currentTime - tasks[TASK_PID].due) >= 0)
+        runTask(&tasks[TASK_PID]);
+
+    // then one background task in the time left before the next PID run. A free running
+    // PID loop has no slack to measure, it takes turns with the background tasks instead.
+    currentTime = micros();
+    if (gyroSync)
+        slack = (int32_t)(cycleTime - (currentTime - previousTime)) > 0 ? cycleTime - (currentTime - previousTime) : 0;
+    else if (cfg.looptime)
+        slack = (int32_t)(tasks[TASK_PID].due - currentTime) > 0 ? tasks[TASK_PID].due - currentTime : 0;
+    else
+        slack = UINT32_MAX;
+    runBackgroundTask(slack, false);
+}
 
-        mixTable();
-        writeServos();
-        writeMotors();
+static void updateLoopStats(void)
+{
+    static uint16_t minCycle = 0xFFFF;
+    static uint16_t maxCycle = 0;
+    static uint32_t sumCycle = 0;
+    static uint16_t cycles = 0;
+
+    if (cycleTime < minCycle)
+        minCycle = cycleTime;
+    if (cycleTime > maxCycle)
+        maxCycle = cycleTime;
+    sumCycle += cycleTime;
+
+    if (++cycles == LOOP_STATS_CYCLES) {
+        cycleJitter = maxCycle - minCycle;
+        if (sumCycle)
+            loopRate = (uint32_t)LOOP_STATS_CYCLES * 1000000 / sumCycle;
+        minCycle = 0xFFFF;
+        maxCycle = 0;
+        sumCycle = 0;
+        cycles = 0;
     }
 }
 
@@ -719,7 +854,7 @@ void annexCode(void)
 		{
 			LED0_ON;
 		}
-		// This will switch to/from 9600 or 115200 baud depending on state. Of course, it should only do it on changes.
+		// This will switch to/from the telemetry baud rate depending on state. Of course, it should only do it on changes.
 		if (feature(FEATURE_TELEMETRY))
 		{
 			initTelemetry(f.ARMED);
@@ -740,9 +875,6 @@ void annexCode(void)
 		}
 	}
 
-	// Hande serial events
-	serialCom();
-	
 	// Flash LED when appropriate for GPS
 	if (sensors(SENSOR_GPS)) 
 	{
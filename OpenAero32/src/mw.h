@@ -40,7 +40,8 @@ typedef enum MultiType
     MULTITYPE_VTAIL4 = 17,
     MULTITYPE_CUSTOM = 18,          // no current GUI displays this
     MULTITYPE_FW_DRAG = 19,			// Flying wing with drag rudders
-    MULTITYPE_LAST = 20
+    MULTITYPE_CUSTOM_AIRPLANE = 20,     // fixed wing servo mix from cfg.customServoMixer
+    MULTITYPE_LAST = 21
 } MultiType;
 
 typedef enum GimbalFlags {
@@ -114,10 +115,40 @@ typedef struct motorMixer_t {
     float yaw;
 } motorMixer_t;
 
+// Inputs of the fixed wing servo mixer, sync with mixerInputNames in cli.c
+enum {
+    MIXIN_ROLL = 0,                         // rcCommand[ROLL]
+    MIXIN_ROLL2,                            // second aileron, rcCommand[ROLL] in BASIC_FLAP mode
+    MIXIN_PITCH,
+    MIXIN_YAW,
+    MIXIN_YAW_POS,                          // rcCommand[YAW] when above 0, else 0
+    MIXIN_YAW_NEG,                          // rcCommand[YAW] when below 0, else 0
+    MIXIN_THROTTLE,
+    MIXIN_FLAP,                             // speed limited flap, reversed by the flap channel
+    MIXIN_STAB_ROLL,                        // axisPID[ROLL] * rollPIDpol, 0 in passthru
+    MIXIN_STAB_PITCH,
+    MIXIN_STAB_YAW,
+    MIXIN_STAB_YAW_POS,
+    MIXIN_STAB_YAW_NEG,
+    MIXIN_PID_YAW,                          // axisPID[YAW] without yawPIDpol, 0 in passthru
+    MIXIN_PID_YAW_POS,
+    MIXIN_PID_YAW_NEG,
+    MIXIN_COUNT
+};
+
+#define MAX_SERVO_MIX       8
+#define SERVO_MIX_SHIFT     6               // servo mixer weights are in 1/64, so 64 is 1.0
+
+typedef struct servoMixer_t {
+    int8_t weight[MIXIN_COUNT];
+} servoMixer_t;
+
 typedef struct mixer_t {
     uint8_t numberMotor;
     uint8_t useServo;
     const motorMixer_t *motor;
+    uint8_t numberServoMix;                 // fixed wing only, servo outputs driven by the servo mixer
+    const servoMixer_t *servo;
 } mixer_t;
    
 enum {
@@ -229,8 +260,11 @@ typedef struct config_t {
 
     // serial(uart1) baudrate
     uint32_t serial_baudrate;
+    uint8_t blackbox_rate;                  // blackbox logs every Nth loop while armed
+    uint8_t telemetry_provider;             // TELEMETRY_FRSKY hub or TELEMETRY_SMARTPORT, sent on uart1 while armed
 
     motorMixer_t customMixer[MAX_MOTORS];   // custom mixtable
+    servoMixer_t customServoMixer[MAX_SERVO_MIX];   // servo mixtable for MULTITYPE_CUSTOM_AIRPLANE
 	uint8_t magic_ef; // magic number, should be 0xEF
 	uint8_t chk; // XOR checksum
 		
@@ -269,6 +303,44 @@ typedef struct flags_t {
     uint8_t CALIBRATE_MAG;
 } flags_t;
 
+typedef enum {
+    TASK_PRIORITY_REALTIME = 0,             // the PID task, runs whenever it is due
+    TASK_PRIORITY_HIGH,
+    TASK_PRIORITY_MEDIUM,
+    TASK_PRIORITY_LOW,
+} taskPriority_e;
+
+enum {
+    TASK_PID = 0,
+    TASK_RC,
+    TASK_BARO,
+    TASK_ALTITUDE,
+    TASK_MAG,
+    TASK_SERIAL,
+    TASK_COUNT
+};
+
+typedef struct serialBudget_t {
+    uint32_t lastTime;
+    int32_t budget;                         // bytes that may be queued now, in 1/1000000 byte
+} serialBudget_t;
+
+typedef struct task_t {
+    const char *name;
+    void (*func)(void);
+    uint8_t priority;                       // taskPriority_e
+    uint32_t period;                        // desired period in us, 0 = whenever it is due
+    bool enabled;
+    bool interleave;                        // may run in the gap between the two gyro reads of the PID task
+    uint32_t estTime;                       // expected run time in us, used to fit the task into slack. Starts at a worst case
+    uint32_t due;                           // micros() of the next run
+    // statistics since the last taskStatsReset()
+    uint32_t maxTime;                       // longest run in us
+    uint32_t totalTime;                     // us spent in the task
+    uint32_t runs;
+    uint32_t missed;                        // runs that started a whole period late
+} task_t;
+
 extern int16_t gyroZero[3];
 extern int16_t gyroData[3];
 extern int16_t angle[2];
@@ -289,6 +361,10 @@ extern uint16_t calibratingG;
 extern uint16_t calibratingS;
 extern int16_t heading;
 extern int16_t annex650_overrun_count;
+extern uint16_t interleaveIdleTime;
+extern uint16_t cycleJitter;
+extern uint16_t loopRate;
+extern bool gyroSync;
 extern int32_t BaroAlt;
 extern int32_t EstAlt;
 extern int32_t AltHold;
@@ -330,7 +406,12 @@ extern sensor_t gyro;
 extern baro_t baro;
 
 // main
+extern task_t tasks[TASK_COUNT];
+extern uint32_t taskStatsStart;
 void loop(void);
+void schedulerInit(void);
+void taskStatsReset(void);
+bool runBackgroundTask(uint32_t slack, bool interleave);
 
 // RC
 void computeRC(void);
@@ -349,6 +430,7 @@ void batteryInit(void);
 uint16_t batteryAdcToVoltage(uint16_t src);
 void ACC_getADC(void);
 void Baro_update(void);
+void Gyro_startRead(void);
 void Gyro_getADC(void);
 void Mag_init(void);
 void Mag_getADC(void);
@@ -356,6 +438,7 @@ void Mag_getADC(void);
 // Output
 void mixerInit(void);
 void mixerLoadMix(int index);
+bool servoMixerLoadMix(int index);
 void writeServos(void);
 void writeMotors(void);
 void writeAllMotors(int16_t mc);
@@ -364,12 +447,16 @@ void mixTable(void);
 // Serial
 void serialInit(uint32_t baudrate);
 void serialCom(void);
+int32_t serialBudgetRefill(serialBudget_t *b, uint32_t baudrate, uint16_t burst);
+void serialBudgetSpend(serialBudget_t *b, uint16_t bytes);
 
 // Config
 void parseRcChannels(const char *input);
 void readEEPROM(void);
 void writeParams(uint8_t b);
 void checkFirstTime(bool reset);
+uint16_t configCrc(const config_t *c);
+bool configApply(const config_t *c, uint8_t version, uint16_t size, uint16_t crc);
 bool sensors(uint32_t mask);
 void sensorsSet(uint32_t mask);
 void sensorsClear(uint32_t mask);
@@ -399,4 +486,9 @@ int32_t wrap_18000(int32_t error);
 
 // telemetry
 void initTelemetry(bool State);
-void sendTelemetry(void);
+bool sendTelemetry(void);
+
+// blackbox
+extern uint32_t blackboxDropped;
+void blackboxUpdate(void);
+bool blackboxFlush(void);
@@ -20,6 +20,7 @@ sensor_t acc;                       // acc access functions
 sensor_t gyro;                      // gyro access functions
 baro_t baro;                        // barometer access functions
 uint8_t accHardware = ACC_DEFAULT;  // which accel chip is used/detected
+bool gyroSync = false;              // main loop paced by gyro data ready instead of cfg.looptime
 
 // AfroFlight32 i2c sensors
 void sensorsAutodetect(void)
@@ -95,6 +96,10 @@ retry:
     // this is safe because either mpu6050 or mpu3050 or lg3d20 sets it, and in case of fail, we never get here.
     gyro.init();
 
+    // only the MPU6050 has its data ready line wired up
+    if (feature(FEATURE_GYRO_SYNC) && haveMpu6k)
+        gyroSync = mpu6050SyncInit(cfg.looptime);
+
     // todo: this is driver specific :(
     if (havel3g4200d) {
         l3g4200dConfig(cfg.gyro_lpf);
@@ -260,6 +265,54 @@ void ACC_getADC(void)
     ACC_Common();
 }
 
+// Standard atmosphere altitude (1 - (p / 101325) ^ 0.190295) * 4433000 in cm, tabulated
+// every 512Pa from 29696Pa to 110080Pa and linearly interpolated in between. Entries sit
+// half the chord sag below the curve, which keeps the error within 3cm above 80kPa and 11cm
+// down to 30kPa, well under the baro noise. tools/baro_alt_test.c regenerates and checks it.
+#define BARO_ALT_PMIN   29696
+#define BARO_ALT_SHIFT  9
+#define BARO_ALT_COUNT  (sizeof(baroAltTab) / sizeof(baroAltTab[0]))
+
+static const int32_t baroAltTab[] = {
+    923315, 911879, 900600, 889472, 878490, 867652, 856951, 846385,
+    835950, 825642, 815458, 805394, 795448, 785616, 775896, 766284,
+    756779, 747377, 738076, 728873, 719767, 710754, 701834, 693003,
+    684261, 675604, 667031, 658541, 650130, 641799, 633545, 625367,
+    617262, 609231, 601270, 593379, 585556, 577801, 570111, 562486,
+    554925, 547425, 539987, 532609, 525289, 518028, 510823, 503674,
+    496581, 489541, 482554, 475619, 468736, 461903, 455120, 448386,
+    441699, 435060, 428468, 421922, 415420, 408963, 402550, 396180,
+    389853, 383567, 377323, 371119, 364956, 358831, 352746, 346699,
+    340690, 334718, 328783, 322885, 317022, 311194, 305402, 299643,
+    293919, 288228, 282570, 276945, 271352, 265791, 260261, 254762,
+    249294, 243856, 238448, 233070, 227720, 222400, 217108, 211844,
+    206607, 201399, 196217, 191062, 185934, 180832, 175756, 170705,
+    165680, 160680, 155704, 150753, 145827, 140924, 136045, 131190,
+    126357, 121548, 116761, 111997, 107255, 102536, 97837, 93161,
+    88506, 83872, 79259, 74666, 70094, 65543, 61011, 56500,
+    52008, 47535, 43082, 38648, 34233, 29837, 25459, 21100,
+    16759, 12436, 8131, 3844, -426, -4678, -8913, -13131,
+    -17331, -21516, -25683, -29834, -33968, -38087, -42189, -46275,
+    -50346, -54401, -58440, -62464, -66472, -70466
+};
+
+static int32_t baroPressureToAltitude(int32_t pressure)
+{
+    uint32_t idx, frac;
+
+    pressure -= BARO_ALT_PMIN;
+    if (pressure < 0)
+        pressure = 0;
+    idx = pressure >> BARO_ALT_SHIFT;
+    frac = pressure & ((1 << BARO_ALT_SHIFT) - 1);
+    if (idx >= BARO_ALT_COUNT - 1) {
+        idx = BARO_ALT_COUNT - 2;
+        frac = 1 << BARO_ALT_SHIFT;
+    }
+
+    return baroAltTab[idx] + (((baroAltTab[idx + 1] - baroAltTab[idx]) * (int32_t)frac) >> BARO_ALT_SHIFT);
+}
+
 void Baro_update(void)
 {
     static uint32_t baroDeadline = 0;
@@ -289,7 +342,7 @@ void Baro_update(void)
         case 3:
             baro.get_up();
             pressure = baro.calculate();
-            BaroAlt = (1.0f - pow(pressure / 101325.0f, 0.190295f)) * 4433000.0f; // centimeter
+            BaroAlt = baroPressureToAltitude(pressure); // centimeter
             state = 0;
             baroDeadline += baro.repeat_delay;
             break;
@@ -376,6 +429,13 @@ static void GYRO_Common(void)
     }
 }
 
+// Get the next gyro sample on its way so Gyro_getADC() finds it fresh
+void Gyro_startRead(void)
+{
+    if (gyro.start)
+        gyro.start();
+}
+
 void Gyro_getADC(void)
 {
     // range: +/- 8192; +/- 2000 deg/sec
@@ -490,10 +550,13 @@ void Mag_getADC(void)
     
     if ((int32_t)(currentTime - t) < 0)
         return;                 //each read is spaced by 100ms
-    t = currentTime + 100000;
 
-    // Read mag sensor
-    Mag_getRawADC();
+    // Read mag sensor. The first pass past the deadline only queues the transfer,
+    // the sample is picked up on a later pass once it has arrived.
+    if (!hmc5883lReadSample(magADC))
+        return;
+    alignSensors(ALIGN_MAG, magADC);
+    t = currentTime + 100000;
 
     magADC[ROLL]  = magADC[ROLL]  * magCal[ROLL];
     magADC[PITCH] = magADC[PITCH] * magCal[PITCH];
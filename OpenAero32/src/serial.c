@@ -24,6 +24,7 @@
 #define MSP_BOXNAMES             116    //out message         the aux switch names
 #define MSP_PIDNAMES             117    //out message         the PID names
 #define MSP_WP                   118    //out message         get a WP, WP# is in the payload, returns (WP#, lat, lon, alt, flags) WP#0-home, WP#16-poshold
+#define MSP_CONFIG               119    //out message         config_t chunk, offset is in the payload, returns (version, size, crc16, offset, data)
 
 #define MSP_SET_RAW_RC           200    //in message          8 rc chan
 #define MSP_SET_RAW_GPS          201    //in message          fix, numsat, lat, lon, alt, speed
@@ -35,6 +36,9 @@
 #define MSP_SET_MISC             207    //in message          powermeter trig + 8 free for future use
 #define MSP_RESET_CONF           208    //in message          no param
 #define MSP_WP_SET               209    //in message          sets a given WP (WP#,lat, lon, alt, flags)
+#define MSP_STREAM               210    //in message          up to 8 (message id, rate in Hz) pairs, no payload stops streaming
+#define MSP_SET_CONFIG           211    //in message          config_t chunk (offset, data), staged in order from offset 0
+#define MSP_CONFIG_COMMIT        212    //in message          version, size, crc16 of the staged config_t, applied and saved if all match
 
 #define MSP_EEPROM_WRITE         250    //in message          no param
 
@@ -45,6 +49,23 @@
 #define MSP_SET_ACC_TRIM 		239 	//in message 		set acc angle trim values
 
 #define INBUF_SIZE 64
+#define CONFIG_CHUNK_SIZE 48            // config_t bytes per MSP_CONFIG / MSP_SET_CONFIG frame
+
+#define MSP_STREAM_SLOTS    8
+#define MSP_STREAM_BURST    64          // bytes the stream may queue ahead of the uart
+
+typedef struct mspStream_t {
+    uint8_t cmd;
+    uint8_t rate;                       // Hz
+    uint32_t next;                      // currentTime the next frame is due
+} mspStream_t;
+
+static mspStream_t streams[MSP_STREAM_SLOTS];
+static uint8_t streamCount = 0;
+
+// bulk config restore, nothing touches cfg until MSP_CONFIG_COMMIT checks the whole copy
+static config_t configStage;
+static uint16_t configStaged = 0;       // bytes received so far
 
 static const char boxnames[] =
     "STABILITY;"
@@ -76,43 +97,47 @@ static const char pidnames[] =
     "VEL;";
 
 static uint8_t checksum, indRX, inBuf[INBUF_SIZE];
-static uint8_t cmdMSP;
+static uint8_t cmdMSP, dataSize, replySize;
+static uint8_t *txStart, *txPtr;    // reply being built in the uart tx ring, NULL if it didn't fit
 static bool guiConnected = false;
 // signal that we're in cli mode
 uint8_t cliMode = 0;
 
+// Replies are built in place in the uart tx ring, the checksum is done once in tailSerialReply()
 void serialize32(uint32_t a)
 {
-    static uint8_t t;
-    t = a;
-    uartWrite(t);
-    checksum ^= t;
-    t = a >> 8;
-    uartWrite(t);
-    checksum ^= t;
-    t = a >> 16;
-    uartWrite(t);
-    checksum ^= t;
-    t = a >> 24;
-    uartWrite(t);
-    checksum ^= t;
+    if (!txPtr)
+        return;
+    txPtr[0] = a;
+    txPtr[1] = a >> 8;
+    txPtr[2] = a >> 16;
+    txPtr[3] = a >> 24;
+    txPtr += 4;
 }
 
 void serialize16(int16_t a)
 {
-    static uint8_t t;
-    t = a;
-    uartWrite(t);
-    checksum ^= t;
-    t = a >> 8 & 0xff;
-    uartWrite(t);
-    checksum ^= t;
+    if (!txPtr)
+        return;
+    txPtr[0] = a;
+    txPtr[1] = a >> 8;
+    txPtr += 2;
 }
 
 void serialize8(uint8_t a)
 {
-    uartWrite(a);
-    checksum ^= a;
+    if (!txPtr)
+        return;
+    *txPtr++ = a;
+}
+
+// copy a block that is already in wire order (little endian)
+void serializeBlock(const void *data, uint8_t len)
+{
+    if (!txPtr)
+        return;
+    memcpy(txPtr, data, len);
+    txPtr += len;
 }
 
 uint8_t read8(void)
@@ -136,10 +161,11 @@ uint32_t read32(void)
 
 void headSerialResponse(uint8_t err, uint8_t s)
 {
+    replySize = s;
+    txStart = txPtr = uartReserve(s + 6);
     serialize8('$');
     serialize8('M');
     serialize8(err ? '!' : '>');
-    checksum = 0;               // start calculating a new checksum
     serialize8(s);
     serialize8(cmdMSP);
 }
@@ -156,14 +182,24 @@ void headSerialError(uint8_t s)
 
 void tailSerialReply(void)
 {
-    serialize8(checksum);
+    uint8_t *end = txStart + replySize + 5;
+    uint8_t *p;
+    uint8_t sum = 0;
+
+    if (!txPtr)
+        return;                 // tx ring full, the reply is dropped
+    if (txPtr < end)            // keep the frame well formed if a reply came up short
+        memset(txPtr, 0, end - txPtr);
+    for (p = txStart + 3; p < end; p++)
+        sum ^= *p;
+    *end = sum;
+    uartCommit(replySize + 6);
+    txPtr = NULL;
 }
 
 void serializeNames(const char *s)
 {
-    const char *c;
-    for (c = s; *c; c++)
-        serialize8(*c);
+    serializeBlock(s, strlen(s));
 }
 
 void serialInit(uint32_t baudrate)
@@ -171,10 +207,18 @@ void serialInit(uint32_t baudrate)
     uartInit(baudrate);
 }
 
+// out messages that take no request payload can be streamed
+static bool streamAllowed(uint8_t cmd)
+{
+    return (cmd >= MSP_IDENT && cmd < MSP_SET_RAW_RC && cmd != MSP_WP && cmd != MSP_CONFIG) || cmd == MSP_ACC_TRIM || cmd == MSP_DEBUG;
+}
+
 static void evaluateCommand(void)
 {
     uint32_t i;
     uint8_t wp_no;
+    uint16_t offset, len, crc;
+    uint8_t version;
 
     switch (cmdMSP) {
     case MSP_SET_RAW_RC:
@@ -231,7 +275,7 @@ static void evaluateCommand(void)
         serialize32(PLATFORM_32BIT);        // "capability"
         break;
     case MSP_STATUS:
-        headSerialReply(10);
+        headSerialReply(14);
         serialize16(cycleTime);
         serialize16(i2cGetErrorCounter());
         serialize16(sensors(SENSOR_ACC) | sensors(SENSOR_BARO) << 1 | sensors(SENSOR_MAG) << 2 | sensors(SENSOR_GPS) << 3);
@@ -239,30 +283,26 @@ static void evaluateCommand(void)
                     rcOptions[BOXCAMSTAB] << BOXCAMSTAB | rcOptions[BOXCAMTRIG] << BOXCAMTRIG | 
                     f.GPS_HOME_MODE << BOXGPSHOME | f.GPS_HOLD_MODE << BOXGPSHOLD | f.PASSTHRU_MODE << BOXPASSTHRU | 
                     rcOptions[BOXBEEPERON] << BOXBEEPERON | rcOptions[BOXLEDMAX] << BOXLEDMAX | rcOptions[BOXLLIGHTS] << BOXLLIGHTS | rcOptions[BOXHEADADJ] << BOXHEADADJ);
+        serialize16(cycleJitter);
+        serialize16(loopRate);
         break;
     case MSP_RAW_IMU:
         headSerialReply(18);
-        for (i = 0; i < 3; i++)
-            serialize16(accSmooth[i]);
-        for (i = 0; i < 3; i++)
-            serialize16(gyroData[i]);
-        for (i = 0; i < 3; i++)
-            serialize16(magADC[i]);
+        serializeBlock(accSmooth, 6);
+        serializeBlock(gyroData, 6);
+        serializeBlock(magADC, 6);
         break;
     case MSP_SERVO:
         headSerialReply(16);
-        for (i = 0; i < 8; i++)
-            serialize16(servo[i]);
+        serializeBlock(servo, 16);
         break;
     case MSP_MOTOR:
         headSerialReply(16);
-        for (i = 0; i < 8; i++)
-            serialize16(motor[i]);
+        serializeBlock(motor, 16);
         break;
     case MSP_RC:
         headSerialReply(16);
-        for (i = 0; i < 8; i++)
-            serialize16(rcData[i]);
+        serializeBlock(rcData, 16);
         break;
     case MSP_RAW_GPS:
         headSerialReply(14);
@@ -281,8 +321,7 @@ static void evaluateCommand(void)
         break;
     case MSP_ATTITUDE:
         headSerialReply(8);
-        for (i = 0; i < 2; i++)
-            serialize16(angle[i]);
+        serializeBlock(angle, 4);
         serialize16(heading);
         serialize16(headFreeModeHold);
         break;
@@ -352,6 +391,44 @@ static void evaluateCommand(void)
             serialize8(0);                   // nav flag will come here
         }
         break;
+    case MSP_CONFIG:
+        offset = read16();
+        len = offset < sizeof(config_t) ? sizeof(config_t) - offset : 0;
+        if (len > CONFIG_CHUNK_SIZE)
+            len = CONFIG_CHUNK_SIZE;
+        crc = configCrc(&cfg);
+        headSerialReply(7 + len);
+        serialize8(cfg.version);
+        serialize16(sizeof(config_t));
+        serialize16(crc);
+        serialize16(offset);
+        serializeBlock((const uint8_t *)&cfg + offset, len);
+        break;
+    case MSP_SET_CONFIG:
+        offset = read16();
+        len = dataSize - 2;
+        if (offset == 0)
+            configStaged = 0;
+        if (dataSize < 2 || offset != configStaged || offset + len > sizeof(config_t)) {
+            configStaged = 0;
+            headSerialError(0);
+            break;
+        }
+        memcpy((uint8_t *)&configStage + offset, &inBuf[indRX], len);
+        configStaged += len;
+        headSerialReply(0);
+        break;
+    case MSP_CONFIG_COMMIT:
+        version = read8();
+        len = read16();
+        crc = read16();
+        if (f.ARMED || configStaged != sizeof(config_t) || !configApply(&configStage, version, len, crc)) {
+            headSerialError(0);
+        } else {
+            headSerialReply(0);
+        }
+        configStaged = 0;
+        break;
     case MSP_RESET_CONF:
         checkFirstTime(true);
         headSerialReply(0);
@@ -375,8 +452,18 @@ static void evaluateCommand(void)
 		break;
     case MSP_DEBUG:
         headSerialReply(8);
-        for (i = 0; i < 4; i++)
-            serialize16(debug[i]);      // 4 variables are here for general monitoring purpose
+        serializeBlock(debug, 8);       // 4 variables are here for general monitoring purpose
+        break;
+    case MSP_STREAM:
+        streamCount = 0;
+        while (indRX + 2 <= dataSize && streamCount < MSP_STREAM_SLOTS) {
+            streams[streamCount].cmd = read8();
+            streams[streamCount].rate = read8();
+            streams[streamCount].next = currentTime;
+            if (streams[streamCount].rate && streamAllowed(streams[streamCount].cmd))
+                streamCount++;
+        }
+        headSerialReply(0);
         break;
     default:                   // we do not know how to handle the (valid) message, indicate error MSP $M!
         headSerialError(0);
@@ -385,11 +472,62 @@ static void evaluateCommand(void)
     tailSerialReply();
 }
 
+// Pacing for data pushed into a uart tx ring without being asked for. The budget refills
+// at baudrate / 10 bytes per second since the last call, up to burst bytes, and returns
+// the whole bytes that may be queued now. It goes negative when a frame overspends it.
+int32_t serialBudgetRefill(serialBudget_t *b, uint32_t baudrate, uint16_t burst)
+{
+    uint32_t dTime;
+
+    dTime = currentTime - b->lastTime;
+    b->lastTime = currentTime;
+    if (dTime > 10000)
+        dTime = 10000;
+    b->budget += dTime * (baudrate / 10);
+    if (b->budget > burst * 1000000)
+        b->budget = burst * 1000000;
+    return b->budget / 1000000;
+}
+
+void serialBudgetSpend(serialBudget_t *b, uint16_t bytes)
+{
+    b->budget -= bytes * 1000000;
+}
+
+// Push the subscribed messages, a few frames per loop. Frames are only queued while the
+// budget is positive, so the tx ring never runs more than about MSP_STREAM_BURST bytes
+// ahead and request replies still get through.
+static void streamSend(void)
+{
+    static serialBudget_t budget;
+    static uint8_t slot = 0;
+    mspStream_t *s;
+    uint8_t n;
+
+    serialBudgetRefill(&budget, cfg.serial_baudrate, MSP_STREAM_BURST);
+
+    // round robin, so a fast stream cannot starve the ones behind it
+    for (n = 0; n < streamCount && budget.budget > 0; n++) {
+        slot = (slot + 1) % streamCount;
+        s = &streams[slot];
+        if ((int32_t)(currentTime - s->next) < 0)
+            continue;
+        s->next += 1000000 / s->rate;
+        if ((int32_t)(currentTime - s->next) >= 0) // fell behind, drop the frames rather than burst them
+            s->next = currentTime + 1000000 / s->rate;
+
+        cmdMSP = s->cmd;
+        evaluateCommand();
+        serialBudgetSpend(&budget, replySize + 6);
+    }
+}
+
 // evaluate all other incoming serial data
 static void evaluateOtherData(uint8_t sr)
 {
     switch (sr) {
         case '#':
+            streamCount = 0;
             cliProcess();
             break;
         case 'R':
@@ -402,7 +540,6 @@ void serialCom(void)
 {
     uint8_t c;
     static uint8_t offset;
-    static uint8_t dataSize;
     static enum _serial_state {
         IDLE,
         HEADER_START,
@@ -418,6 +555,17 @@ void serialCom(void)
         return;
     }
 
+    // telemetry owns the port while armed
+    if (sendTelemetry())
+        return;
+
+    // the blackbox log owns the port while armed, requests are dropped
+    if (blackboxFlush()) {
+        while (uartAvailable())
+            uartRead();
+        return;
+    }
+
     while (uartAvailable()) {
         c = uartRead();
 
@@ -455,8 +603,7 @@ void serialCom(void)
             c_state = IDLE;
         }
     }
-    if (!cliMode && !uartAvailable() && feature(FEATURE_TELEMETRY) && f.ARMED) { // The first 2 conditions should never evaluate to true but I'm putting it here anyway - silpstream
-        sendTelemetry();
-        return;
-    }
+    // only between frames, replies reuse cmdMSP
+    if (streamCount && c_state == IDLE)
+        streamSend();
 }
@@ -1,11 +1,23 @@
 /* 
  * FrSky Telemetry implementation by silpstream @ rcgroups
+ *
+ * Telemetry owns uart1 while armed and never writes to it directly from the loop.
+ * FrSky hub frames are coded into a small RAM ring, one frame group per call, and
+ * moved into the uart tx ring at the baud rate, a few bytes per call. SmartPort
+ * (telemetry_provider = 1) is polled by the receiver: each poll is answered with
+ * the next sensor value from a cache that is refreshed one entry per call.
+ * SmartPort is inverted and half duplex, so it needs an inverter and a diode from
+ * TX to RX on the F103.
  */
 #include "board.h"
 #include "mw.h"
 
 #define CYCLETIME             125
 
+#define TELEMETRY_BUFFER_SIZE 128       // must be a power of 2
+#define TELEMETRY_MAX_GROUP   64        // worst case size of one frame group, all bytes stuffed
+#define TELEMETRY_BURST       8         // bytes the tx ring may run ahead of the baud rate
+
 #define PROTOCOL_HEADER       0x5E
 #define PROTOCOL_TAIL         0x5E
 
@@ -45,28 +57,43 @@
 #define ID_GYRO_Y             0x41
 #define ID_GYRO_Z             0x42
 
+static uint8_t buffer[TELEMETRY_BUFFER_SIZE];
+static uint8_t bufferHead = 0;
+static uint8_t bufferTail = 0;
+
+static uint8_t bufferFree(void)
+{
+    return (bufferTail - bufferHead - 1) & (TELEMETRY_BUFFER_SIZE - 1);
+}
+
+static void bufferPut(uint8_t data)
+{
+    buffer[bufferHead] = data;
+    bufferHead = (bufferHead + 1) & (TELEMETRY_BUFFER_SIZE - 1);
+}
+
 static void sendDataHead(uint8_t id)
 {
-    uartWrite(PROTOCOL_HEADER);
-    uartWrite(id);
+    bufferPut(PROTOCOL_HEADER);
+    bufferPut(id);
 }
 
 static void sendTelemetryTail(void)
 {
-    uartWrite(PROTOCOL_TAIL);
+    bufferPut(PROTOCOL_TAIL);
 }
 
 static void serializeFrsky(uint8_t data)
 {
     // take care of byte stuffing
     if (data == 0x5e) {
-        uartWrite(0x5d);
-        uartWrite(0x3e);
+        bufferPut(0x5d);
+        bufferPut(0x3e);
     } else if (data == 0x5d) {
-        uartWrite(0x5d);
-        uartWrite(0x3d);
+        bufferPut(0x5d);
+        bufferPut(0x3d);
     } else
-        uartWrite(data);
+        bufferPut(data);
 }
 
 static void serialize16(int16_t a)
@@ -152,51 +179,297 @@ static void sendHeading(void)
     serialize16(0);
 }
 
-static bool telemetryEnabled = false;
+// SmartPort
+#define SMARTPORT_BAUDRATE    57600
+#define SMARTPORT_START       0x7E
+#define SMARTPORT_STUFF       0x7D
+#define SMARTPORT_SENSOR_ID   0x98      // physical id 24 with its parity bits
+#define SMARTPORT_DATA_FRAME  0x10
 
-void initTelemetry(bool State)
+enum {
+    SP_ALTITUDE = 0,
+    SP_VFAS,
+    SP_ACC_X,
+    SP_ACC_Y,
+    SP_ACC_Z,
+    SP_T1,
+    SP_T2,
+    SP_LATITUDE,
+    SP_LONGITUDE,
+    SP_GPS_ALTITUDE,
+    SP_GPS_SPEED,
+    SP_COURSE,
+    SP_SENSOR_COUNT
+};
+
+static const uint16_t smartPortIds[SP_SENSOR_COUNT] = {
+    0x0100,             // altitude, cm
+    0x0210,             // battery voltage, 0.01V
+    0x0700,             // acc x, 0.01g
+    0x0710,
+    0x0720,
+    0x0400,             // temperature 1, degrees
+    0x0410,             // temperature 2, used for the number of satellites
+    0x0800,             // gps latitude and longitude share an id
+    0x0800,
+    0x0820,             // gps altitude, cm
+    0x0830,             // gps speed, knots * 1000
+    0x0840,             // course, degrees * 100
+};
+
+static uint32_t smartPortValues[SP_SENSOR_COUNT];
+static uint16_t smartPortValid = 0;     // bit per sensor, set when it has something to report
+
+// gps coordinates are sent in minutes * 10000, bit 31 set for longitude, bit 30 for south/west
+static uint32_t smartPortCoord(int32_t coord, bool longitude)
+{
+    uint32_t value = abs(coord);
+
+    value = (value + value / 2) / 25;
+    if (longitude)
+        value |= 0x80000000;
+    if (coord < 0)
+        value |= 0x40000000;
+    return value;
+}
+
+// bring one cache entry up to date, so a poll never has to compute anything
+static void smartPortRefresh(uint8_t sensor)
 {
-    if (State != telemetryEnabled) {
-        if (State)
-            serialInit(9600);
+    bool valid = true;
+    bool gps = sensors(SENSOR_GPS) && f.GPS_FIX;
+    uint32_t value = 0;
+
+    switch (sensor) {
+        case SP_ALTITUDE:
+            valid = sensors(SENSOR_BARO);
+            value = EstAlt;
+            break;
+        case SP_VFAS:
+            valid = feature(FEATURE_VBAT);
+            value = vbat * 10;
+            break;
+        case SP_ACC_X:
+        case SP_ACC_Y:
+        case SP_ACC_Z:
+            value = (int32_t)accSmooth[sensor - SP_ACC_X] * 100 / acc_1G;
+            break;
+        case SP_T1:
+            value = telemTemperature1 / 10;
+            break;
+        case SP_T2:
+            valid = sensors(SENSOR_GPS);
+            value = GPS_numSat;
+            break;
+        case SP_LATITUDE:
+            valid = gps;
+            value = smartPortCoord(GPS_coord[LAT], false);
+            break;
+        case SP_LONGITUDE:
+            valid = gps;
+            value = smartPortCoord(GPS_coord[LON], true);
+            break;
+        case SP_GPS_ALTITUDE:
+            valid = gps;
+            value = GPS_altitude * 100;
+            break;
+        case SP_GPS_SPEED:
+            valid = gps;
+            value = GPS_speed * 1944 / 100;
+            break;
+        case SP_COURSE:
+            valid = gps;
+            value = GPS_ground_course * 10;
+            break;
+    }
+
+    smartPortValues[sensor] = value;
+    if (valid)
+        smartPortValid |= 1 << sensor;
+    else
+        smartPortValid &= ~(1 << sensor);
+}
+
+static uint8_t *smartPortPut(uint8_t *p, uint8_t data)
+{
+    if (data == SMARTPORT_START || data == SMARTPORT_STUFF) {
+        *p++ = SMARTPORT_STUFF;
+        data ^= 0x20;
+    }
+    *p++ = data;
+    return p;
+}
+
+// answer a poll with the next valid sensor, or stay silent when there is none
+static void smartPortReply(void)
+{
+    static uint8_t sensor = 0;
+    uint8_t frame[16];
+    uint8_t *p = frame;
+    uint8_t *tx;
+    uint16_t crc = 0;
+    uint32_t value;
+    uint8_t i, data;
+
+    for (i = 0; i < SP_SENSOR_COUNT; i++) {
+        sensor = (sensor + 1) % SP_SENSOR_COUNT;
+        if (smartPortValid & (1 << sensor))
+            break;
+    }
+    if (i == SP_SENSOR_COUNT)
+        return;
+
+    value = smartPortValues[sensor];
+    for (i = 0; i < 7; i++) {
+        if (i == 0)
+            data = SMARTPORT_DATA_FRAME;
+        else if (i < 3)
+            data = smartPortIds[sensor] >> ((i - 1) * 8);
         else
-            serialInit(cfg.serial_baudrate);
-        telemetryEnabled = State;
+            data = value >> ((i - 3) * 8);
+        p = smartPortPut(p, data);
+        crc += data;
+        crc += crc >> 8;
+        crc &= 0xFF;
+    }
+    p = smartPortPut(p, 0xFF - crc);
+
+    // the reply slot is short, a reply that doesn't fit now is useless later
+    tx = uartReserve(p - frame);
+    if (!tx)
+        return;
+    memcpy(tx, frame, p - frame);
+    uartCommit(p - frame);
+}
+
+static void smartPortProcess(void)
+{
+    static bool start = false;
+    static uint8_t sensor = 0;
+    uint8_t c;
+
+    while (uartAvailable()) {
+        c = uartRead();
+        if (start && c == SMARTPORT_SENSOR_ID)
+            smartPortReply();
+        start = (c == SMARTPORT_START);
     }
+
+    smartPortRefresh(sensor);
+    sensor = (sensor + 1) % SP_SENSOR_COUNT;
+}
+
+static bool telemetryEnabled = false;
+
+// Called every loop. The baud rate only changes once the tx ring has drained,
+// so a reply or frame that is still queued goes out at the rate it was meant for.
+void initTelemetry(bool State)
+{
+    if (State == telemetryEnabled || !uartTransmitEmpty())
+        return;
+
+    if (State)
+        uartChangeBaud(cfg.telemetry_provider == TELEMETRY_SMARTPORT ? SMARTPORT_BAUDRATE : 9600);
+    else
+        uartChangeBaud(cfg.serial_baudrate);
+    bufferHead = bufferTail = 0;
+    smartPortValid = 0;
+    telemetryEnabled = State;
 }
 
 static uint32_t lastCycleTime = 0;
 static uint8_t cycleNum = 0;
+static uint8_t pendingGroups = 0;       // hub frame groups due but not coded yet
 
-void sendTelemetry(void)
-{
-    if (millis() - lastCycleTime >= CYCLETIME) {
-        lastCycleTime = millis();
-        cycleNum++;
+enum {
+    GROUP_FAST = 1 << 0,                // 125ms
+    GROUP_MEDIUM = 1 << 1,              // 500ms
+    GROUP_SLOW = 1 << 2,                // 1s
+    GROUP_TIME = 1 << 3,                // 5s
+};
 
-        // Sent every 125ms
+// code the first pending frame group into the ring
+static void queueGroup(void)
+{
+    if (pendingGroups & GROUP_FAST) {
+        pendingGroups &= ~GROUP_FAST;
         sendAccel();
-        sendTelemetryTail();
+    } else if (pendingGroups & GROUP_MEDIUM) {
+        pendingGroups &= ~GROUP_MEDIUM;
+        sendBaro();
+        sendHeading();
+    } else if (pendingGroups & GROUP_SLOW) {
+        pendingGroups &= ~GROUP_SLOW;
+        sendTemperature1();
+        if (feature(FEATURE_VBAT))
+            sendVoltage();
+        if (sensors(SENSOR_GPS))
+            sendGPS();
+    } else {
+        pendingGroups &= ~GROUP_TIME;
+        sendTime();
+    }
+    sendTelemetryTail();
+}
 
-        if ((cycleNum % 4) == 0) {      // Sent every 500ms
-            sendBaro();
-            sendHeading();
-            sendTelemetryTail();
-        }
+// Move coded bytes into the uart tx ring at the baud rate
+static void flushBuffer(void)
+{
+    static serialBudget_t budget;
+    int32_t allowed;
+    uint8_t len, first;
+    uint8_t *p;
 
-        if ((cycleNum % 8) == 0) {      // Sent every 1s
-            sendTemperature1();
-            if (feature(FEATURE_VBAT))
-                sendVoltage();
-            if (sensors(SENSOR_GPS))
-                sendGPS();
-            sendTelemetryTail();
-        }
+    allowed = serialBudgetRefill(&budget, 9600, TELEMETRY_BURST);
+    len = (bufferHead - bufferTail) & (TELEMETRY_BUFFER_SIZE - 1);
+    if (len > allowed)
+        len = allowed;
+    if (!len || !(p = uartReserve(len)))
+        return;
+
+    first = TELEMETRY_BUFFER_SIZE - bufferTail;
+    if (first > len)
+        first = len;
+    memcpy(p, &buffer[bufferTail], first);
+    memcpy(p + first, buffer, len - first);
+    uartCommit(len);
+    bufferTail = (bufferTail + len) & (TELEMETRY_BUFFER_SIZE - 1);
+    serialBudgetSpend(&budget, len);
+}
+
+// Called from serialCom(). Returns true while telemetry owns the serial port.
+bool sendTelemetry(void)
+{
+    if (!telemetryEnabled)
+        return false;
 
-        if (cycleNum == 40) {     //Frame 3: Sent every 5s
+    if (cfg.telemetry_provider == TELEMETRY_SMARTPORT) {
+        smartPortProcess();
+        return true;
+    }
+
+    // the hub protocol is one way, requests are dropped
+    while (uartAvailable())
+        uartRead();
+
+    if (millis() - lastCycleTime >= CYCLETIME) {
+        lastCycleTime = millis();
+        cycleNum++;
+
+        pendingGroups |= GROUP_FAST;
+        if ((cycleNum % 4) == 0)
+            pendingGroups |= GROUP_MEDIUM;
+        if ((cycleNum % 8) == 0)
+            pendingGroups |= GROUP_SLOW;
+        if (cycleNum == 40) {
             cycleNum = 0;
-            sendTime();
-            sendTelemetryTail();
+            pendingGroups |= GROUP_TIME;
         }
     }
+
+    // one group per call keeps the work per loop small
+    if (pendingGroups && bufferFree() >= TELEMETRY_MAX_GROUP)
+        queueGroup();
+    flushBuffer();
+    return true;
 }
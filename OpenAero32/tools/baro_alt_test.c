@@ -0,0 +1,340 @@
+/*
+ * Check of the baro altitude table in src/sensors.c and the fixed point altitude filter in
+ * src/imu.c getEstimatedAltitude().
+ *
+ * Build on the host:  cc -O2 -Ihost -I../src -no-pie -o baro_alt_test baro_alt_test.c ../src/fastmath.c -lm \
+ *                         -Wl,--unresolved-symbols=ignore-all
+ * Usage:              baro_alt_test          check, exits with 1 on a failure
+ *                     baro_alt_test table    print baroAltTab[] for pasting into sensors.c
+ *
+ * sensors.c and imu.c are included whole to get at their statics. Only the altitude code
+ * runs, so the sensor drivers they call are left unresolved at link time, which needs a
+ * non-PIE binary.
+ *
+ * The table is regenerated from the standard atmosphere formula and compared entry by
+ * entry, then the interpolated altitude is checked at every Pa of its range. The filter is
+ * run through a 75s simulated flight with climbs, descents, a banked turn and baro and acc
+ * noise, next to the float version it replaced, and the two are compared.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/sensors.c"
+#include "../src/imu.c"
+#undef printf                           // printf.h points it at the firmware's UART printf
+
+#define LOOP_US         2500
+#define BARO_US         10000
+#define FLIGHT_S        75
+#define BARO_NOISE_CM   10.0
+#define ACC_NOISE       8.0
+
+// error bounds of the interpolated table, in cm
+#define TABLE_ERR_LOW   11.5            // 30kPa to 80kPa
+#define TABLE_ERR_HIGH  3.0             // 80kPa and up
+// allowed difference between the fixed point filter and the float one
+#define FILTER_ALT_MAX  10.0            // cm
+#define FILTER_VEL_MEAN 2.0             // cm/s
+
+// what sensors.c and imu.c expect from the rest of the firmware
+uint32_t currentTime = 0;
+int16_t heading = 0;
+int16_t annex650_overrun_count = 0;
+uint16_t interleaveIdleTime = 0;
+config_t cfg;
+flags_t f;
+int16_t debug[4];
+uint16_t InflightcalibratingA;
+uint16_t AccInflightCalibrationMeasurementDone;
+uint16_t AccInflightCalibrationSavetoEEProm;
+uint16_t AccInflightCalibrationActive;
+uint16_t batteryWarningVoltage;
+uint8_t batteryCellCount;
+
+uint32_t micros(void) { return currentTime; }
+bool sensors(uint32_t mask) { return (mask & (SENSOR_ACC | SENSOR_BARO)) != 0; }
+bool feature(uint32_t mask) { (void)mask; return false; }
+
+static double exactAltitude(double pressure)
+{
+    return (1.0 - pow(pressure / 101325.0, 0.190295)) * 4433000.0;
+}
+
+static double exactPressure(double altitude)
+{
+    return 101325.0 * pow(1.0 - altitude / 4433000.0, 1.0 / 0.190295);
+}
+
+#define TABLE_COUNT ((110080 - BARO_ALT_PMIN) / (1 << BARO_ALT_SHIFT) + 1)
+
+// How far the curve sags below the chord between entries i and i + 1
+static double tableSag(unsigned i)
+{
+    double p0 = BARO_ALT_PMIN + (double)(i << BARO_ALT_SHIFT), p, a0, a1, sag = 0;
+    int step;
+
+    a0 = exactAltitude(p0);
+    a1 = exactAltitude(p0 + (1 << BARO_ALT_SHIFT));
+    for (step = 1; step < (1 << BARO_ALT_SHIFT); step++) {
+        p = p0 + step;
+        if (a0 + (a1 - a0) * step / (1 << BARO_ALT_SHIFT) - exactAltitude(p) > sag)
+            sag = a0 + (a1 - a0) * step / (1 << BARO_ALT_SHIFT) - exactAltitude(p);
+    }
+    return sag;
+}
+
+// Entries sit half the neighbouring sag below the curve, which splits the interpolation
+// error evenly either side of it instead of having it all on the high side
+static long tableEntry(unsigned i)
+{
+    double sag;
+
+    if (i == 0)
+        sag = tableSag(0);
+    else if (i == TABLE_COUNT - 1)
+        sag = tableSag(i - 1);
+    else
+        sag = (tableSag(i - 1) + tableSag(i)) / 2;
+    return lround(exactAltitude(BARO_ALT_PMIN + (double)(i << BARO_ALT_SHIFT)) - sag / 2);
+}
+
+static void printTable(void)
+{
+    unsigned i;
+
+    printf("static const int32_t baroAltTab[] = {");
+    for (i = 0; i < TABLE_COUNT; i++)
+        printf("%s%ld%s", i % 8 ? " " : "\n    ", tableEntry(i), i < TABLE_COUNT - 1 ? "," : "\n");
+    printf("};\n");
+}
+
+static int checkTable(void)
+{
+    unsigned i, wrong = 0;
+    int32_t p;
+    double err, low = 0, high = 0;
+
+    if (BARO_ALT_COUNT != TABLE_COUNT)
+        wrong++;
+    for (i = 0; i < BARO_ALT_COUNT && i < TABLE_COUNT; i++) {
+        if (baroAltTab[i] != tableEntry(i)) {
+            printf("baroAltTab[%u] is %ld, should be %ld\n", i, (long)baroAltTab[i], tableEntry(i));
+            wrong++;
+        }
+    }
+    for (p = BARO_ALT_PMIN; p <= BARO_ALT_PMIN + (int32_t)((BARO_ALT_COUNT - 1) << BARO_ALT_SHIFT); p++) {
+        err = fabs(baroPressureToAltitude(p) - exactAltitude(p));
+        if (p < 80000 && err > low)
+            low = err;
+        if (p >= 80000 && err > high)
+            high = err;
+    }
+    printf("table:                %u entries, %u wrong\n", (unsigned)BARO_ALT_COUNT, wrong);
+    printf("interpolation error:  max %.1fcm below 80kPa, %.1fcm above\n", low, high);
+    return wrong == 0 && low <= TABLE_ERR_LOW && high <= TABLE_ERR_HIGH;
+}
+
+// getEstimatedAltitude() as it was in float, with its own state so both can run side by side
+static float refAccLPFVel[3];
+static int32_t refEstAlt;
+static int16_t refBaroPID;
+static int16_t refErrorAltitudeI;
+static float refVel;
+
+static void referenceAltitude(void)
+{
+    static uint32_t deadLine = INIT_DELAY;
+    static int16_t baroHistTab[BARO_TAB_SIZE_MAX];
+    static int8_t baroHistIdx;
+    static int32_t baroHigh;
+    uint32_t dTime;
+    int16_t error;
+    float invG;
+    int16_t accZ;
+    static int32_t lastBaroAlt;
+    float baroVel;
+    float accVelScale = 9.80665f / acc_1G / 10000.0f;
+
+    if ((int32_t)(currentTime - deadLine) < UPDATE_INTERVAL)
+        return;
+    dTime = currentTime - deadLine;
+    deadLine = currentTime;
+
+    baroHistTab[baroHistIdx] = BaroAlt / 10;
+    baroHigh += baroHistTab[baroHistIdx];
+    baroHigh -= baroHistTab[(baroHistIdx + 1) % cfg.baro_tab_size];
+
+    baroHistIdx++;
+    if (baroHistIdx == cfg.baro_tab_size)
+        baroHistIdx = 0;
+
+    refEstAlt = refEstAlt * cfg.baro_noise_lpf + (baroHigh * 10.0f / (cfg.baro_tab_size - 1)) * (1.0f - cfg.baro_noise_lpf);
+
+    error = constrain(AltHold - refEstAlt, -300, 300);
+    error = applyDeadband16(error, 10);
+    refBaroPID = constrain((cfg.P8[PIDALT] * error / 100), -150, +150);
+
+    refErrorAltitudeI += error * cfg.I8[PIDALT] / 50;
+    refErrorAltitudeI = constrain(refErrorAltitudeI, -30000, 30000);
+    refBaroPID += (refErrorAltitudeI / 500);
+
+    invG = InvSqrt(isq(EstG.V.X) + isq(EstG.V.Y) + isq(EstG.V.Z));
+    accZ = (refAccLPFVel[ROLL] * EstG.V.X + refAccLPFVel[PITCH] * EstG.V.Y + refAccLPFVel[YAW] * EstG.V.Z) * invG - acc_1G;
+    accZ = applyDeadband16(accZ, acc_1G / cfg.accz_deadband);
+
+    refVel += accZ * accVelScale * dTime;
+
+    baroVel = (refEstAlt - lastBaroAlt) / (dTime / 1000000.0f);
+    baroVel = constrain(baroVel, -300, 300);
+    baroVel = applyDeadbandFloat(baroVel, 10);
+    lastBaroAlt = refEstAlt;
+
+    refVel = refVel * cfg.baro_cf + baroVel * (1.0f - cfg.baro_cf);
+
+    refBaroPID -= constrain(cfg.D8[PIDALT] * applyDeadbandFloat(refVel, 5) / 20, -150, 150);
+}
+
+// reproducible noise
+static uint32_t rngState = 2463534242u;
+
+static double uniform(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState + 0.5) / 4294967296.0;
+}
+
+static double gauss(void)
+{
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+// Smooth 0 to 1 over d seconds from t0, with its first and second derivative
+static double ease(double t, double t0, double d, double *rate, double *accel)
+{
+    double x = (t - t0) / d;
+
+    if (x <= 0 || x >= 1) {
+        *rate = *accel = 0;
+        return x <= 0 ? 0 : 1;
+    }
+    *rate = 30 * x * x * (1 - x) * (1 - x) / d;
+    *accel = 60 * x * (1 - x) * (1 - 2 * x) / (d * d);
+    return x * x * x * (10 - 15 * x + 6 * x * x);
+}
+
+// Height above the 500m field in cm and the vertical acceleration in m/s^2: climb 30m,
+// hold, drop 20m, climb 10m, settle
+static double flightHeight(double t, double *accel)
+{
+    static const double moves[][3] = { { 8, 6, 3000 }, { 25, 4, -2000 }, { 40, 3, 1000 }, { 55, 8, -500 } };
+    double h = 0, rate, a;
+    unsigned i;
+
+    *accel = 0;
+    for (i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        h += moves[i][2] * ease(t, moves[i][0], moves[i][1], &rate, &a);
+        *accel += moves[i][2] * a / 100.0;
+    }
+    return h;
+}
+
+// Bank angle in radians: a 30 degree turn from 30s to 45s
+static double flightBank(double t, double *rate)
+{
+    double r1, r2, a;
+    double bank = 0.5236 * (ease(t, 30, 1.5, &r1, &a) - ease(t, 43.5, 1.5, &r2, &a));
+
+    *rate = 0.5236 * (r1 - r2);
+    return bank;
+}
+
+static int checkFilter(void)
+{
+    double t, height, accel, bank, bankRate, g;
+    double altDiff, altMax = 0, altSum = 0, velDiff, velSum = 0, velMax = 0, pidSum = 0, pidMax = 0;
+    double estErr, estMax = 0, refErr, refMax = 0;
+    uint32_t nextBaro = 0;
+    long n = 0;
+    int axis;
+
+    cfg.acc_lpf_factor = 4;
+    cfg.acc_lpf_for_velocity = 10;
+    cfg.gyro_cmpf_factor = 400;
+    cfg.accz_deadband = 50;
+    cfg.baro_tab_size = 21;
+    cfg.baro_noise_lpf = 0.6f;
+    cfg.baro_cf = 0.985f;
+    cfg.P8[PIDALT] = 50;
+    cfg.I8[PIDALT] = 25;
+    cfg.D8[PIDALT] = 80;
+    acc_1G = 512;
+    imuInit();
+    AltHold = 50000 + 1000;
+
+    for (t = 0; t < FLIGHT_S; t += LOOP_US * 1e-6) {
+        currentTime += LOOP_US;
+        height = flightHeight(t, &accel);
+        bank = flightBank(t, &bankRate);
+
+        // a level turn needs 1 / cos(bank) of lift
+        g = 1.0 / cos(bank) + accel / 9.80665;
+        accADC[ROLL] = lrint(sin(bank) * g * acc_1G + ACC_NOISE * gauss());
+        accADC[PITCH] = lrint(ACC_NOISE * gauss());
+        accADC[YAW] = lrint(cos(bank) * g * acc_1G + ACC_NOISE * gauss());
+        gyroADC[ROLL] = lrint(bankRate / (GYRO_SCALE * 1e6));
+        gyroADC[PITCH] = gyroADC[YAW] = 0;
+        getEstimatedAttitude();
+        for (axis = 0; axis < 3; axis++)
+            refAccLPFVel[axis] = refAccLPFVel[axis] * (1.0f - (1.0f / cfg.acc_lpf_for_velocity)) + accADC[axis] * (1.0f / cfg.acc_lpf_for_velocity);
+
+        if ((int32_t)(currentTime - nextBaro) >= 0) {
+            BaroAlt = baroPressureToAltitude(lrint(exactPressure(50000 + height + BARO_NOISE_CM * gauss())));
+            nextBaro += BARO_US;
+        }
+
+        if (currentTime > INIT_DELAY && (currentTime - INIT_DELAY) % UPDATE_INTERVAL == 0) {
+            getEstimatedAltitude();
+            referenceAltitude();
+            if (t < 10)
+                continue;           // let the baro history fill
+            altDiff = fabs(EstAlt - refEstAlt);
+            velDiff = fabs(debug[2] - refVel);
+            altSum += altDiff;
+            velSum += velDiff;
+            pidSum += abs(BaroPID - refBaroPID);
+            if (altDiff > altMax)
+                altMax = altDiff;
+            if (velDiff > velMax)
+                velMax = velDiff;
+            if (abs(BaroPID - refBaroPID) > pidMax)
+                pidMax = abs(BaroPID - refBaroPID);
+            estErr = fabs(EstAlt - 50000 - height);
+            refErr = fabs(refEstAlt - 50000 - height);
+            if (estErr > estMax)
+                estMax = estErr;
+            if (refErr > refMax)
+                refMax = refErr;
+            n++;
+        }
+    }
+    printf("filter vs float:      altitude mean %.2f max %.0fcm, velocity mean %.2f max %.1fcm/s, BaroPID mean %.2f max %.0f\n",
+           altSum / n, altMax, velSum / n, velMax, pidSum / n, pidMax);
+    printf("altitude vs truth:    fixed point max %.0fcm, float max %.0fcm\n", estMax, refMax);
+    return altMax <= FILTER_ALT_MAX && velSum / n <= FILTER_VEL_MEAN;
+}
+
+int main(int argc, char **argv)
+{
+    int ok;
+
+    if (argc > 1 && !strcmp(argv[1], "table")) {
+        printTable();
+        return 0;
+    }
+    ok = checkTable();
+    ok &= checkFilter();
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
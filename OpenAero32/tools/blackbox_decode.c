@@ -0,0 +1,128 @@
+/*
+ * Blackbox log decoder, see src/blackbox.c for the format.
+ *
+ * Build on the host:  cc -o blackbox_decode blackbox_decode.c
+ * Usage:              blackbox_decode LOGFILE > flight.csv
+ *
+ * Every log in the file is written as a CSV block starting with its field names.
+ * P frames that follow lost or damaged data are skipped until the next I frame.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MAX_FIELDS 40
+
+static int32_t values[MAX_FIELDS];
+static int fieldCount = 0;
+static int haveReference = 0;
+static unsigned long frames = 0, skipped = 0, junk = 0;
+
+static int readVarint(FILE *in, uint32_t *value)
+{
+    uint32_t result = 0;
+    int shift, c;
+
+    for (shift = 0; shift < 35; shift += 7) {
+        c = getc(in);
+        if (c == EOF)
+            return 0;
+        result |= (uint32_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void readHeader(FILE *in)
+{
+    char line[1024];
+    char *name;
+    int i;
+
+    if (!fgets(line, sizeof(line), in))
+        return;
+    line[strcspn(line, "\r\n")] = 0;
+    if (strncmp(line, " fields:", 8) != 0)
+        return;
+
+    fieldCount = 0;
+    haveReference = 0;
+    for (name = strtok(line + 8, ","); name && fieldCount < MAX_FIELDS; name = strtok(NULL, ","))
+        printf("%s%s", fieldCount++ ? "," : "", name);
+    printf("\n");
+    for (i = 0; i < MAX_FIELDS; i++)
+        values[i] = 0;
+}
+
+static void readFrame(FILE *in, int intra)
+{
+    uint32_t raw;
+    int i;
+
+    for (i = 0; i < fieldCount; i++) {
+        if (!readVarint(in, &raw)) {
+            haveReference = 0;
+            return;
+        }
+        values[i] = intra ? unzigzag(raw) : values[i] + unzigzag(raw);
+    }
+
+    if (intra)
+        haveReference = 1;
+    if (!haveReference) {
+        skipped++;
+        return;
+    }
+
+    for (i = 0; i < fieldCount; i++)
+        printf("%s%d", i ? "," : "", (int)values[i]);
+    printf("\n");
+    frames++;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    int c;
+
+    if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while ((c = getc(in)) != EOF) {
+        switch (c) {
+        case 'H':
+            readHeader(in);
+            break;
+        case 'I':
+        case 'P':
+            if (fieldCount)
+                readFrame(in, c == 'I');
+            else
+                junk++;
+            break;
+        case 'E':
+            haveReference = 0;
+            break;
+        case '\n':
+            break;
+        default:
+            junk++;
+            haveReference = 0;
+            break;
+        }
+    }
+
+    fprintf(stderr, "%lu frames, %lu skipped, %lu stray bytes\n", frames, skipped, junk);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Accuracy sweep of src/fastmath.c against libm, over the full input range of each function.
+ *
+ * Build on the host:  cc -O2 -Ihost -I../src -o fastmath_test fastmath_test.c ../src/fastmath.c -lm
+ * Usage:              fastmath_test
+ *
+ * Prints the worst error found for each function with the input that produced it, and
+ * exits with 1 if any of them is outside the bound listed in fastmath.h.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "fastmath.h"
+
+#define TWO_PI 6.283185307179586
+
+typedef struct {
+    const char *name;
+    double bound;
+    double worst;
+    float at;
+} result_t;
+
+static int failures = 0;
+
+static float fromBits(uint32_t i)
+{
+    float f;
+    memcpy(&f, &i, sizeof(f));
+    return f;
+}
+
+static void track(result_t *r, double err, float x)
+{
+    if (err > r->worst || err != err) {
+        r->worst = err;
+        r->at = x;
+    }
+}
+
+static void report(result_t *r)
+{
+    int ok = r->worst <= r->bound;
+
+    printf("%-28s max %.4g at %.9g, bound %.3g  %s\n", r->name, r->worst, r->at, r->bound, ok ? "ok" : "FAIL");
+    if (!ok)
+        failures++;
+}
+
+// Angle error with the +-pi wrap taken out, so atan2 near the negative x axis compares fairly
+static double angleError(double a, double b)
+{
+    double d = fabs(a - b);
+    return d > M_PI ? TWO_PI - d : d;
+}
+
+static void testAtan2(void)
+{
+    result_t r = { "fast_atan2", 1.2e-5, 0, 0 };
+    int e, i;
+    double a;
+    float x, y;
+
+    // every direction at magnitudes from tiny to huge, the result only depends on y / x
+    for (e = -120; e <= 120; e += 8) {
+        for (i = 0; i < (1 << 18); i++) {
+            a = TWO_PI * i / (1 << 18) - M_PI;
+            x = ldexp(cos(a), e);
+            y = ldexp(sin(a), e);
+            track(&r, angleError(fast_atan2(y, x), atan2(y, x)), y / x);
+        }
+    }
+    // axes and the origin
+    track(&r, fabs(fast_atan2(0.0f, 1.0f)), 0);
+    track(&r, fabs(fast_atan2(1.0f, 0.0f) - M_PI / 2), 0);
+    track(&r, fabs(fast_atan2(-1.0f, 0.0f) + M_PI / 2), 0);
+    track(&r, fabs(fast_atan2(0.0f, -1.0f) - M_PI), 0);
+    track(&r, fabs(fast_atan2(0.0f, 0.0f)), 0);
+    report(&r);
+}
+
+static void testAsin(void)
+{
+    result_t r = { "fast_asin", 7.0e-5, 0, 0 };
+    uint32_t i;
+    float x;
+
+    // every 16th float in [0, 1], then the sign and the clamp beyond +-1
+    for (i = 0; i <= 0x3F800000; i += 16) {
+        x = fromBits(i);
+        track(&r, fabs(fast_asin(x) - asin(x)), x);
+        track(&r, fabs(fast_asin(-x) + asin(x)), -x);
+    }
+    track(&r, fabs(fast_asin(1.0f) - M_PI / 2), 1.0f);
+    track(&r, fabs(fast_asin(1.5f) - M_PI / 2), 1.5f);
+    track(&r, fabs(fast_asin(-1e9f) + M_PI / 2), -1e9f);
+    report(&r);
+}
+
+static void testSincos(void)
+{
+    result_t r = { "fast_sincos |x| <= 2pi", 4.0e-6, 0, 0 };
+    result_t far = { "fast_sincos |x| <= 1000", 0, 0, 0 };
+    int i;
+    float x, s, c;
+
+    for (i = -(1 << 22); i <= (1 << 22); i++) {
+        x = (float)(TWO_PI * i / (1 << 22));
+        fast_sincos(x, &s, &c);
+        track(&r, fmax(fabs(s - sin(x)), fabs(c - cos(x))), x);
+    }
+    report(&r);
+
+    // beyond that the reduction x - n * pi / 2 in float costs about an ulp of x
+    far.bound = r.bound + 1000 * FLT_EPSILON;
+    for (i = -(1 << 22); i <= (1 << 22); i++) {
+        x = (float)(1000.0 * i / (1 << 22));
+        fast_sincos(x, &s, &c);
+        track(&far, fmax(fabs(s - sin(x)), fabs(c - cos(x))), x);
+    }
+    report(&far);
+}
+
+static void testSqrt(void)
+{
+    result_t inv = { "InvSqrt", 6.6e-4, 0, 0 };
+    result_t sq = { "fast_sqrt", 1.0e-6, 0, 0 };
+    uint32_t i;
+    float x;
+    double exact;
+
+    // both only depend on the mantissa and the exponent's parity, so [1, 4) is exhaustive.
+    // The rest of the normal range is swept more coarsely to be sure.
+    for (i = 0x3F800000; i < 0x40800000; i++) {
+        x = fromBits(i);
+        exact = sqrt(x);
+        track(&inv, fabs(InvSqrt(x) * exact - 1.0), x);
+        track(&sq, fabs(fast_sqrt(x) / exact - 1.0), x);
+    }
+    for (i = 0x00800000; i < 0x7F800000; i += 257) {
+        x = fromBits(i);
+        exact = sqrt(x);
+        track(&inv, fabs(InvSqrt(x) * exact - 1.0), x);
+        track(&sq, fabs(fast_sqrt(x) / exact - 1.0), x);
+    }
+    track(&sq, fabs(fast_sqrt(0.0f)), 0.0f);
+    track(&sq, fabs(fast_sqrt(-4.0f)), -4.0f);
+    report(&inv);
+    report(&sq);
+}
+
+int main(void)
+{
+    testAtan2();
+    testAsin();
+    testSincos();
+    testSqrt();
+    return failures ? 1 : 0;
+}
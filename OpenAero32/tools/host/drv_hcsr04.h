@@ -0,0 +1,4 @@
+/*
+ * board.h includes the sonar driver header, which isn't part of this source tree.
+ */
+#pragma once
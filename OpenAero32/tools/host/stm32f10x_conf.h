@@ -0,0 +1,19 @@
+/*
+ * Host stand-in for the StdPeriph headers, just enough for board.h so the tools in
+ * this directory can build firmware sources that don't touch the hardware.
+ */
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t CR1, CR2, SR, DR, IDR, ODR, BSRR, BRR;
+} GPIO_TypeDef, I2C_TypeDef, TIM_TypeDef, USART_TypeDef;
+
+#define GPIOA       ((GPIO_TypeDef *)0)
+#define GPIOB       ((GPIO_TypeDef *)0)
+#define GPIOC       ((GPIO_TypeDef *)0)
+#define GPIO_Pin_3  0x0008
+#define GPIO_Pin_4  0x0010
+#define GPIO_Pin_12 0x1000
+#define GPIO_Pin_13 0x2000
@@ -0,0 +1,214 @@
+/*
+ * Attitude estimator bench for src/imu.c.
+ *
+ * Build on the host:  cc -O2 -Ihost -I../src -o imu_bench imu_bench.c ../src/fastmath.c -lm
+ * Usage:              imu_bench
+ *
+ * imu.c is included whole so EstG can be checked directly, and computeIMU() runs unchanged
+ * at a 2.5ms looptime against a simulated airframe: 500s of alternating calm and 1-3.5rad/s
+ * manoeuvring, gyro quantised with noise and a residual bias, and 8LSB of acc noise.
+ * Reported are the angle between EstG and true gravity, the roll/pitch error of angle[]
+ * below 60 degrees of tilt, the drift over 10s of gyro only and the host time per
+ * computeIMU(). The F103 has no FPU, so the host time is only good for comparing changes
+ * to the same code, not as a cost on the board.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../src/imu.c"
+#undef printf                           // printf.h points it at the firmware's UART printf
+
+#define LOOP_US     2500
+#define SUBSTEPS    10
+#define WARMUP_S    10
+#define RUN_S       500
+#define DRIFT_S     10
+#define TIMING_RUNS 2000000
+#define ACC_1G      512
+#define ACC_NOISE   8.0
+#define GYRO_NOISE  1.0
+
+// what imu.c expects from the rest of the firmware
+uint16_t acc_1G = ACC_1G;
+uint32_t currentTime = 0;
+int16_t heading = 0;
+int16_t annex650_overrun_count = 0;
+uint16_t interleaveIdleTime = 0;
+bool gyroSync = true;                   // one gyro read per loop, no interleave wait
+config_t cfg;
+flags_t f;
+int16_t debug[4];
+
+static uint32_t simTime = 0;
+static int16_t simGyro[3], simAcc[3];
+
+uint32_t micros(void) { return simTime; }
+bool sensors(uint32_t mask) { return (mask & SENSOR_ACC) != 0; }
+bool feature(uint32_t mask) { (void)mask; return false; }
+bool runBackgroundTask(uint32_t slack, bool interleave) { (void)slack; (void)interleave; return false; }
+void annexCode(void) {}
+void Mag_init(void) {}
+void Gyro_startRead(void) {}
+void ACC_getADC(void) { memcpy(accADC, simAcc, sizeof(accADC)); }
+void Gyro_getADC(void) { memcpy(gyroADC, simGyro, sizeof(gyroADC)); }
+
+// reproducible noise
+static uint32_t rngState = 2463534242u;
+
+static double uniform(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState + 0.5) / 4294967296.0;
+}
+
+static double gauss(void)
+{
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+// Body rates in rad/s, ROLL/PITCH/YAW as the gyro reports them. Even 5s segments are calm,
+// odd ones sweep each axis with a mix of sines peaking at 1 to 3.5rad/s.
+static void bodyRate(double t, double *rate)
+{
+    static const double freq[3][3] = { { 0.31, 1.7, 4.3 }, { 0.23, 1.3, 3.7 }, { 0.17, 0.9, 2.9 } };
+    double amp;
+    int seg = (int)(t / 5.0), axis;
+
+    amp = (seg & 1) ? 1.0 + 2.5 * ((seg * 7919) % 11) / 10.0 : 0.1;
+    for (axis = 0; axis < 3; axis++)
+        rate[axis] = amp / 3.0 * (sin(2 * M_PI * freq[axis][0] * t + axis) + sin(2 * M_PI * freq[axis][1] * t + 2 * axis) + sin(2 * M_PI * freq[axis][2] * t + 3 * axis));
+}
+
+// Gravity in EstG axes turns at w = (-pitch, roll, yaw), see rotateV(); rotate it exactly
+static void turnGravity(double *g, const double *rate, double dt)
+{
+    double w[3] = { -rate[PITCH], rate[ROLL], rate[YAW] };
+    double n = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+    double k[3], kxg[3], kdg, c, s;
+    int i;
+
+    if (n < 1e-12)
+        return;
+    for (i = 0; i < 3; i++)
+        k[i] = w[i] / n;
+    kxg[0] = k[1] * g[2] - k[2] * g[1];
+    kxg[1] = k[2] * g[0] - k[0] * g[2];
+    kxg[2] = k[0] * g[1] - k[1] * g[0];
+    kdg = k[0] * g[0] + k[1] * g[1] + k[2] * g[2];
+    c = cos(n * dt);
+    s = sin(n * dt);
+    for (i = 0; i < 3; i++)
+        g[i] = g[i] * c + kxg[i] * s + k[i] * kdg * (1.0 - c);
+}
+
+static double gyroBias[3];
+
+// Advance the airframe one looptime and latch what the sensors would report
+static void step(double *g, double t, bool accOn)
+{
+    double rate[3], mean[3] = { 0, 0, 0 };
+    int i, axis;
+
+    for (i = 0; i < SUBSTEPS; i++) {
+        bodyRate(t + (i + 0.5) * LOOP_US * 1e-6 / SUBSTEPS, rate);
+        turnGravity(g, rate, LOOP_US * 1e-6 / SUBSTEPS);
+        for (axis = 0; axis < 3; axis++)
+            mean[axis] += rate[axis] / SUBSTEPS;
+    }
+    for (axis = 0; axis < 3; axis++) {
+        simGyro[axis] = lrint(mean[axis] / (GYRO_SCALE * 1e6) + gyroBias[axis] + GYRO_NOISE * gauss());
+        simAcc[axis] = accOn ? lrint(g[axis] * ACC_1G + ACC_NOISE * gauss()) : 0;
+    }
+    simTime += LOOP_US;
+}
+
+static double estError(const double *g)
+{
+    double dot = EstG.V.X * g[0] + EstG.V.Y * g[1] + EstG.V.Z * g[2];
+    double len = sqrt(EstG.V.X * EstG.V.X + EstG.V.Y * EstG.V.Y + EstG.V.Z * EstG.V.Z);
+
+    dot /= len;
+    if (dot > 1.0)
+        dot = 1.0;
+    return acos(dot) * 180.0 / M_PI;
+}
+
+int main(void)
+{
+    double g[3] = { 0, 0, 1 };
+    double t, err, sum = 0, worst = 0, angleWorst = 0, e;
+    double truth[2];
+    long n = 0;
+    int axis, i;
+    struct timespec t0, t1;
+    int16_t gyroLog[1024][3], accLog[1024][3];
+
+    cfg.gyro_cmpf_factor = 400;
+    cfg.acc_lpf_factor = 4;
+    cfg.acc_lpf_for_velocity = 10;
+    cfg.mixerConfiguration = MULTITYPE_QUADX;
+    gyroBias[ROLL] = 0.7;
+    gyroBias[PITCH] = -0.5;
+    gyroBias[YAW] = 0.3;
+    imuInit();
+
+    // settle level and still
+    for (t = 0; t < WARMUP_S; t += LOOP_US * 1e-6) {
+        double still[3] = { 0, 0, 1 };
+        for (axis = 0; axis < 3; axis++) {
+            simGyro[axis] = lrint(gyroBias[axis] + GYRO_NOISE * gauss());
+            simAcc[axis] = lrint(still[axis] * ACC_1G + ACC_NOISE * gauss());
+        }
+        simTime += LOOP_US;
+        computeIMU();
+    }
+
+    for (t = 0; t < RUN_S; t += LOOP_US * 1e-6) {
+        step(g, t, true);
+        computeIMU();
+        err = estError(g);
+        sum += err;
+        n++;
+        if (err > worst)
+            worst = err;
+        if (g[2] > 0.5) {
+            truth[ROLL] = atan2(g[0], g[2]) * 1800.0 / M_PI;
+            truth[PITCH] = atan2(g[1], g[2]) * 1800.0 / M_PI;
+            for (axis = 0; axis < 2; axis++) {
+                e = fabs(angle[axis] - truth[axis]) / 10.0;
+                if (e > angleWorst)
+                    angleWorst = e;
+            }
+        }
+    }
+    printf("gravity error:        mean %.3f max %.3f deg over %lds\n", sum / n, worst, (long)RUN_S);
+    printf("angle[] error:        max %.2f deg below 60 deg tilt\n", angleWorst);
+
+    // gyro only, a zero acc vector fails the 0.6-1.4G gate so no correction is applied
+    err = estError(g);
+    for (; t < RUN_S + DRIFT_S; t += LOOP_US * 1e-6) {
+        step(g, t, false);
+        computeIMU();
+    }
+    printf("gyro only drift:      %.3f deg after %ds (from %.3f)\n", estError(g), DRIFT_S, err);
+
+    // cost, replaying recorded input so the simulation stays out of the timing
+    for (i = 0; i < 1024; i++) {
+        step(g, t, true);
+        t += LOOP_US * 1e-6;
+        memcpy(gyroLog[i], simGyro, sizeof(simGyro));
+        memcpy(accLog[i], simAcc, sizeof(simAcc));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < TIMING_RUNS; i++) {
+        memcpy(simGyro, gyroLog[i & 1023], sizeof(simGyro));
+        memcpy(simAcc, accLog[i & 1023], sizeof(simAcc));
+        simTime += LOOP_US;
+        computeIMU();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("host time:            %.1f ns per computeIMU()\n", ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / TIMING_RUNS);
+    return 0;
+}
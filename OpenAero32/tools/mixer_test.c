@@ -0,0 +1,272 @@
+/*
+ * Equivalence test of the fixed wing servo mixer in src/mixer.c against the hard coded
+ * AIRPLANE, FLYING_WING and FW_DRAG mixing it replaced.
+ *
+ * Build on the host:  cc -O2 -Ihost -I../src -o mixer_test mixer_test.c
+ * Usage:              mixer_test
+ *
+ * mixer.c is included whole. mixTable() and writeServos() run on random sticks, PID
+ * outputs, flap settings, PID polarities, servo reverses, trims and passthru, next to the
+ * old code kept below as the reference, and the servo and motor values written are
+ * compared. CUSTOM_AIRPLANE loaded from each preset must match that preset. Exits with 1
+ * on any difference.
+ */
+#include <stdio.h>
+
+#include "../src/mixer.c"
+#undef printf                           // printf.h points it at the firmware's UART printf
+
+#define SEEDS   6
+#define STEPS   20000
+
+// what mixer.c expects from the rest of the firmware
+config_t cfg;
+flags_t f;
+int16_t angle[2];
+int16_t axisPID[3];
+int16_t rcCommand[9];
+int16_t rcData[8];
+uint8_t rcOptions[CHECKBOXITEMS];
+
+static int16_t written[MAX_SERVOS];
+static uint8_t writtenCount;
+static int16_t writtenMotor[MAX_MOTORS];
+
+bool feature(uint32_t mask) { (void)mask; return false; }
+void pwmWriteServo(uint8_t index, uint16_t value) { written[index] = value; writtenCount++; }
+void pwmWriteMotor(uint8_t index, uint16_t value) { writtenMotor[index] = value; }
+
+// Reference, the old mixing. The flap state is global so a run can start from a known one.
+static int16_t refFlap, refSlowFlaps;
+static uint8_t refFlapskip;
+
+static void refAirplane(int16_t *out)
+{
+    int16_t flaperons, left_roll = 0, right_roll = 0;
+    uint8_t speed;
+
+    switch (cfg.flapmode) {
+        case BASIC_FLAP:
+            left_roll = rcCommand[ROLL];
+            right_roll = left_roll;
+            if (cfg.flapchan != NOCHAN)
+                refFlap = rcCommand[cfg.flapchan];
+            else
+                refFlap = 0;
+            break;
+        case PREMIXED_FLAP:
+            left_roll = rcCommand[ROLL];
+            right_roll = rcCommand[cfg.aileron2];
+            refFlap = rcCommand[cfg.flapchan];
+            break;
+        case ADV_FLAP:
+            left_roll = rcCommand[ROLL];
+            right_roll = rcCommand[cfg.aileron2];
+            if (cfg.flapchan != NOCHAN)
+                refFlap = rcCommand[cfg.flapchan];
+            else
+                refFlap = 0;
+            break;
+    }
+
+    if (cfg.flapspeed) {
+        if (abs(refSlowFlaps - refFlap) >= cfg.flapstep)
+            speed = cfg.flapstep;
+        else
+            speed = 1;
+        if ((refSlowFlaps < refFlap) && (refFlapskip == cfg.flapspeed))
+            refSlowFlaps += speed;
+        else if ((refSlowFlaps > refFlap) && (refFlapskip == cfg.flapspeed))
+            refSlowFlaps -= speed;
+    } else {
+        refSlowFlaps = refFlap;
+    }
+    refFlapskip++;
+    if (refFlapskip > cfg.flapspeed)
+        refFlapskip = 0;
+
+    // the old code read servoreverse[NOCHAN] past the end, the flap is 0 then anyway
+    flaperons = refSlowFlaps * (cfg.flapchan == NOCHAN ? 1 : cfg.servoreverse[cfg.flapchan]);
+
+    out[0] = left_roll + flaperons;
+    out[1] = right_roll - flaperons;
+    out[2] = rcCommand[YAW];
+    out[3] = rcCommand[PITCH];
+    out[4] = flaperons;
+    if (!f.PASSTHRU_MODE) {
+        out[0] -= (cfg.rollPIDpol * axisPID[ROLL]);
+        out[1] -= (cfg.rollPIDpol * axisPID[ROLL]);
+        out[2] -= (cfg.yawPIDpol * axisPID[YAW]);
+        out[3] += (cfg.pitchPIDpol * axisPID[PITCH]);
+    }
+}
+
+static void refFlyingWing(int16_t *out)
+{
+    out[0] = (rcCommand[PITCH] + rcCommand[ROLL]) >> 1;
+    out[1] = (rcCommand[PITCH] - rcCommand[ROLL]) >> 1;
+    out[2] = rcCommand[YAW];
+    if (!f.PASSTHRU_MODE) {
+        out[0] = out[0] + (cfg.pitchPIDpol * axisPID[PITCH]) + (cfg.rollPIDpol * axisPID[ROLL]);
+        out[1] = out[1] + (cfg.pitchPIDpol * axisPID[PITCH]) - (cfg.rollPIDpol * axisPID[ROLL]);
+        out[2] -= axisPID[YAW];
+    }
+}
+
+static void refFwDrag(int16_t *out)
+{
+    out[0] = (rcCommand[PITCH] + rcCommand[ROLL]) >> 1;
+    out[1] = (rcCommand[PITCH] - rcCommand[ROLL]) >> 1;
+    out[2] = rcCommand[YAW] >= 0 ? rcCommand[YAW] : 0;
+    out[3] = rcCommand[YAW] <= 0 ? rcCommand[YAW] : 0;
+    if (!f.PASSTHRU_MODE) {
+        out[0] = out[0] + (cfg.pitchPIDpol * axisPID[PITCH]) - (cfg.rollPIDpol * axisPID[ROLL]);
+        out[1] = out[1] + (cfg.pitchPIDpol * axisPID[PITCH]) + (cfg.rollPIDpol * axisPID[ROLL]);
+        if (axisPID[YAW] < 0)
+            out[2] -= axisPID[YAW];
+        if (axisPID[YAW] > 0)
+            out[3] -= axisPID[YAW];
+    }
+}
+
+// reproducible random numbers
+static uint32_t rngState;
+
+static int32_t rnd(int32_t lo, int32_t hi)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return lo + (int32_t)(rngState % (uint32_t)(hi - lo + 1));
+}
+
+static int16_t sign(void)
+{
+    return rnd(0, 1) ? 1 : -1;
+}
+
+static void randomConfig(void)
+{
+    static const uint8_t flapChannels[] = { AUX1, AUX2, AUX3, AUX4, NOCHAN };
+    int i;
+
+    cfg.flapmode = rnd(BASIC_FLAP, ADV_FLAP);
+    cfg.flapchan = flapChannels[rnd(0, cfg.flapmode == PREMIXED_FLAP ? 3 : 4)];
+    cfg.aileron2 = rnd(AUX1, AUX4);
+    cfg.flapspeed = rnd(0, 3) ? rnd(1, 20) : 0;
+    cfg.flapstep = rnd(1, 6);
+    cfg.rollPIDpol = sign();
+    cfg.pitchPIDpol = sign();
+    cfg.yawPIDpol = sign();
+    for (i = 0; i < 8; i++) {
+        cfg.servoreverse[i] = sign();
+        cfg.servotrim[i] = rnd(1400, 1600);
+        cfg.servoendpoint_low[i] = rnd(900, 1200);
+        cfg.servoendpoint_high[i] = rnd(1800, 2100);
+    }
+}
+
+// Bring the flap state of both to rest at 0, with the flap channel centred
+static void settleFlaps(void)
+{
+    uint8_t speed = cfg.flapspeed;
+    int16_t out[MAX_SERVOS];
+
+    memset(rcCommand, 0, sizeof(rcCommand));
+    cfg.flapspeed = 0;
+    flapInput();
+    refAirplane(out);
+    cfg.flapspeed = speed;
+}
+
+// Run one frame for a seed, comparing what reaches the servo and motor outputs
+static unsigned long runFrame(uint8_t mixer, void (*reference)(int16_t *out), uint8_t rows, uint32_t seed)
+{
+    int16_t out[MAX_SERVOS];
+    unsigned long mismatches = 0;
+    int step, i;
+
+    rngState = seed;
+    randomConfig();
+    cfg.mixerConfiguration = mixer;
+    mixerInit();
+    settleFlaps();
+    if (numberServoMix != rows) {
+        printf("mixer %d drives %d servos, expected %d\n", mixer, numberServoMix, rows);
+        return 1;
+    }
+
+    for (step = 0; step < STEPS; step++) {
+        for (i = 0; i < 9; i++)
+            rcCommand[i] = rnd(-500, 500);
+        rcCommand[THROTTLE] = rnd(1000, 2000);
+        for (i = 0; i < 8; i++)
+            rcData[i] = rnd(1000, 2000);
+        for (i = 0; i < 3; i++)
+            axisPID[i] = rnd(-400, 400);
+        if (rnd(0, 9) == 0)
+            f.PASSTHRU_MODE = !f.PASSTHRU_MODE;
+        f.ARMED = rnd(0, 7) != 0;
+
+        memset(out, 0, sizeof(out));
+        reference(out);
+        for (i = 0; i < rows; i++)
+            out[i] = constrain(out[i] * cfg.servoreverse[i] + cfg.servotrim[i], cfg.servoendpoint_low[i], cfg.servoendpoint_high[i]);
+
+        writtenCount = 0;
+        mixTable();
+        writeServos();
+        writeMotors();
+
+        if (writtenCount != rows)
+            mismatches++;
+        for (i = 0; i < rows; i++) {
+            if (written[i] != out[i]) {
+                if (!mismatches)
+                    printf("mixer %d seed %u step %d servo %d: %d, old code %d\n", mixer, seed, step, i, written[i], out[i]);
+                mismatches++;
+            }
+        }
+        for (i = 0; i < 2; i++) {
+            if (writtenMotor[i] != (f.ARMED ? rcData[THROTTLE] : cfg.mincommand))
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void)
+{
+    static const struct {
+        uint8_t mixer;
+        const char *name;
+        void (*reference)(int16_t *out);
+        uint8_t rows;
+    } frames[] = {
+        { MULTITYPE_AIRPLANE, "AIRPLANE", refAirplane, 5 },
+        { MULTITYPE_FLYING_WING, "FLYING_WING", refFlyingWing, 3 },
+        { MULTITYPE_FW_DRAG, "FW_DRAG", refFwDrag, 4 },
+    };
+    unsigned long mismatches, total = 0;
+    uint32_t seed;
+    unsigned i;
+
+    cfg.mincommand = 1000;
+    for (i = 0; i < sizeof(frames) / sizeof(frames[0]); i++) {
+        mismatches = 0;
+        for (seed = 1; seed <= SEEDS; seed++)
+            mismatches += runFrame(frames[i].mixer, frames[i].reference, frames[i].rows, seed * 2654435761u);
+        printf("%-28s %lu mismatches in %d steps\n", frames[i].name, mismatches, SEEDS * STEPS);
+        total += mismatches;
+
+        // the same matrix through the custom mixer, mixers[] is 1-based for servoMixerLoadMix()
+        servoMixerLoadMix(frames[i].mixer - 1);
+        mismatches = 0;
+        for (seed = 1; seed <= SEEDS; seed++)
+            mismatches += runFrame(MULTITYPE_CUSTOM_AIRPLANE, frames[i].reference, frames[i].rows, seed * 2654435761u);
+        printf("CUSTOM_AIRPLANE from %-7s %lu mismatches in %d steps\n", frames[i].name, mismatches, SEEDS * STEPS);
+        total += mismatches;
+    }
+    printf("%s\n", total ? "FAIL" : "ok");
+    return total ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Check of the u-blox message handling in src/gps.c.
+ *
+ * Build on the host:  cc -O2 -no-pie -Ihost -I../src -o ubx_test ubx_test.c -lm -Wl,--unresolved-symbols=ignore-all
+ * Usage:              ubx_test
+ *
+ * gps.c is included whole and fed UBX frames a byte at a time, as the uart2 callback
+ * would. Before NAV-PVT has been seen the older NAV messages are used and nothing is sent
+ * back. After it, each older NAV message that still arrives must be answered with a
+ * CFG-MSG turning it off, and anything else left alone. Exits with 1 on a failure.
+ */
+#include <stdio.h>
+
+#include "../src/gps.c"
+#undef printf                           // printf.h points it at the firmware's UART printf
+
+// what gps.c's UBX path expects from the rest of the firmware
+config_t cfg;
+flags_t f;
+int32_t GPS_coord[2];
+uint8_t GPS_numSat;
+uint8_t GPS_Present;
+uint16_t GPS_altitude, GPS_speed;
+uint16_t GPS_ground_course;
+
+static uint8_t sent[256];
+static int sentCount;
+static int failures = 0;
+
+void uart2Write(uint8_t ch)
+{
+    if (sentCount < (int)sizeof(sent))
+        sent[sentCount] = ch;
+    sentCount++;
+}
+
+// Feed a frame with an all zero payload, returns what GPS_UBLOX_newFrame() reported
+static bool feed(uint8_t msgClass, uint8_t msgId, uint16_t length)
+{
+    uint8_t header[4] = { msgClass, msgId, length & 0xFF, length >> 8 };
+    uint8_t ck_a = 0, ck_b = 0;
+    int i;
+
+    GPS_UBLOX_newFrame(PREAMBLE1);
+    GPS_UBLOX_newFrame(PREAMBLE2);
+    for (i = 0; i < 4; i++) {
+        GPS_UBLOX_newFrame(header[i]);
+        ck_a += header[i];
+        ck_b += ck_a;
+    }
+    for (i = 0; i < length; i++) {
+        GPS_UBLOX_newFrame(0);
+        ck_b += ck_a;
+    }
+    GPS_UBLOX_newFrame(ck_a);
+    return GPS_UBLOX_newFrame(ck_b);
+}
+
+static void expect(const char *what, bool ok)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+        failures++;
+}
+
+// The CFG-MSG frame that switches NAV message msgId off, checksum from the ubloxInit table
+static bool sentOff(int at, uint8_t msgId, uint8_t ck_a, uint8_t ck_b)
+{
+    const uint8_t frame[11] = { 0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, msgId, 0x00, ck_a, ck_b };
+
+    return sentCount >= at + 11 && memcmp(&sent[at], frame, sizeof(frame)) == 0;
+}
+
+int main(void)
+{
+    feed(CLASS_NAV, MSG_STATUS, sizeof(ubx_nav_status));
+    feed(CLASS_NAV, MSG_POSLLH, sizeof(ubx_nav_posllh));
+    expect("POSLLH+VELNED before PVT give a solution", feed(CLASS_NAV, MSG_VELNED, sizeof(ubx_nav_velned)));
+    expect("nothing sent back before PVT", sentCount == 0);
+
+    expect("PVT gives a solution", feed(CLASS_NAV, MSG_PVT, sizeof(ubx_nav_pvt)));
+    expect("nothing sent back for PVT", sentCount == 0);
+
+    // the ubloxInit checksums less one, the rate is the last payload byte
+    expect("POSLLH after PVT is ignored", !feed(CLASS_NAV, MSG_POSLLH, sizeof(ubx_nav_posllh)));
+    expect("and switched off", sentOff(0, MSG_POSLLH, 0x0D, 0x46));
+    feed(CLASS_NAV, MSG_STATUS, sizeof(ubx_nav_status));
+    expect("STATUS switched off", sentOff(11, MSG_STATUS, 0x0E, 0x48));
+    feed(CLASS_NAV, MSG_SOL, sizeof(ubx_nav_solution));
+    expect("SOL switched off", sentOff(22, MSG_SOL, 0x11, 0x4E));
+    expect("VELNED after PVT is ignored", !feed(CLASS_NAV, MSG_VELNED, sizeof(ubx_nav_velned)));
+    expect("and switched off", sentOff(33, MSG_VELNED, 0x1D, 0x66));
+
+    feed(CLASS_ACK, MSG_ACK_ACK, 2);
+    expect("ACK-ACK left alone", sentCount == 44);
+    expect("PVT still gives a solution", feed(CLASS_NAV, MSG_PVT, sizeof(ubx_nav_pvt)));
+    expect("nothing sent back for PVT", sentCount == 44);
+
+    return failures ? 1 : 0;
+}
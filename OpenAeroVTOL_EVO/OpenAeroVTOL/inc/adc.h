@@ -2,9 +2,27 @@
  * adc.h
  ********************************************************************/
 
+//***********************************************************
+//* Defines
+//***********************************************************
+
+#define ADC_SLOT_VBAT		0		// Slot numbers into ADC_Channels[] and ADC_Filtered[]
+#define ADC_CHANNELS		1		// Number of channels sampled in the background
+
+#define ADC_OVERSAMPLE		16		// Conversions summed per channel. Sum of 10-bit values must fit in 16 bits
+#define ADC_FILTER_SHIFT	2		// Low-pass filter strength applied to each sum
+
 //***********************************************************
 //* Externals
 //***********************************************************
 
 extern void Init_ADC(void);
 extern void read_adc(uint8_t channel);
+extern void sample_adc(void);
+extern uint16_t get_adc_filtered(uint8_t slot);
+
+extern const uint8_t ADC_Channels[];
+extern uint16_t ADC_Filtered[ADC_CHANNELS];
+extern uint16_t adc_sum;
+extern uint8_t adc_count;
+extern uint8_t adc_slot;
@@ -8,6 +8,18 @@
 // This limits the available LCD contrast
 //#define KK2Mini
 
+// Uncomment this line to run the MPU6050 at 1kHz and average all the samples 
+// queued in its FIFO since the last loop, rather than reading single samples
+//#define SENSOR_FIFO
+
+// Uncomment this line to correct for a board that is not mounted exactly square.
+// The angles are in degrees, about the MPU6050's own axes as seen in the 
+// "Forward" orientation, and are applied on top of the selected orientation.
+//#define BOARD_ALIGNMENT
+#define ALIGN_ROLL	0					// About the chip's Y axis
+#define ALIGN_PITCH	0					// About the chip's X axis
+#define ALIGN_YAW	0					// About the chip's Z axis
+
 // Uncomment this line to have the factory setup default to a quad "+" setup on OUT1 to OUT4
 //#define QUADCOPTERPLUS
 #define QUADCOPTERX
@@ -1,6 +1,7 @@
 /*********************************************************************
  * glcd_driver.h
  ********************************************************************/
+#include <stdbool.h>
 
 //***********************************************************
 //* LCD Defines
@@ -43,6 +44,9 @@
 // ST7565 project parameters
 #define LCDWIDTH 128
 #define LCDHEIGHT 64
+#define LCD_BUFFER_SIZE 1024		// 128 x 64 pixels, one bit each
+#define LCD_ALL_PAGES 0xFF		// Page mask for a full-frame flush
+#define LCD_FLUSH_BYTES 128		// LCD data sent per main loop pass when updating the screen (one page)
 
 // Serial data - PD1 for KK 2.0
 #define SID_DDR DDRD
@@ -74,6 +78,13 @@
 #define CS_PORT PORTD
 #define CS 5
 
+//***********************************************************
+//* Externals
+//***********************************************************
+
+// Buffer holds the last menu list drawn
+extern bool menu_buffer_valid;
+
 // Misc
 #define swap(a, b) { uint8_t t = a; a = b; b = t; }
 
@@ -87,7 +98,12 @@ void st7565_data(uint8_t c);
 void st7565_init(void);
 void st7565_set_brightness(uint8_t val);
 void write_buffer(uint8_t *buffer);
+void write_buffer_pages(uint8_t *buffer, uint8_t pages);
+void flush_buffer_start(uint8_t *buffer, uint8_t pages);
+bool flush_buffer_tick(uint16_t bytes);
 void clear_buffer(uint8_t *buff);
+void clear_buffer_pages(uint8_t *buff, uint8_t pages);
+uint8_t lcd_page_mask(uint8_t y, uint8_t h);
 void write_logo_buffer(uint8_t *buffer);
 void clear_screen(void);
 
@@ -10,5 +10,8 @@ extern void ReadGyros(void);
 extern void CalibrateGyrosFast(void);
 extern bool CalibrateGyrosSlow(void);
 extern void get_raw_gyros(void);
+extern void update_gyro_orientation(void);
+extern void init_board_alignment(void);
+extern void align_sensor_vector(const int16_t *in, int16_t *out);
 
 extern int16_t gyroADC[NUMBEROFAXIS];		// Holds 16-bit gyro values
@@ -2,6 +2,13 @@
  * i2c.h
  ********************************************************************/
 
+//***********************************************************
+//* Defines
+//***********************************************************
+
+#define SAMPLE_GYRO	0x01			// SensorSampleFresh flags
+#define SAMPLE_ACC	0x02
+
 //***********************************************************
 //* Externals
 //***********************************************************
@@ -10,5 +17,11 @@ extern void writeI2Cbyte(uint8_t address, uint8_t location, uint8_t value);
 extern void readI2CbyteArray(uint8_t address, uint8_t location, uint8_t *array,uint8_t size);
 extern void init_i2c_gyros(void);
 extern void init_i2c_accs(void);
+extern void read_sensors(void);
+extern void start_sensor_read(void);
+extern void set_sensor_rate(void);
+
+extern sensor_sample_t SensorSample;
+extern uint8_t SensorSampleFresh;
 
 
@@ -93,6 +93,14 @@
 /** defines the data direction (writing to I2C device) in i2c_start(),i2c_rep_start() */
 #define I2C_WRITE   0
 
+/** states of an interrupt-driven transfer, see i2c_read_async() */
+#define I2C_ASYNC_IDLE   0
+#define I2C_ASYNC_BUSY   1
+#define I2C_ASYNC_ERROR  2
+
+/** state of the current interrupt-driven transfer */
+extern volatile uint8_t i2c_async_state;
+
 
 /**
  @brief initialize the I2C master interace. Need to be called only once 
@@ -173,5 +181,26 @@ extern unsigned char i2c_readNak(void);
 extern unsigned char i2c_read(unsigned char ack);
 #define i2c_read(ack)  (ack) ? i2c_readAck() : i2c_readNak(); 
 
+/**
+ @brief    start an interrupt-driven read of a block of registers
+ 
+ Returns at once. Use i2c_async_wait() before touching the buffer 
+ or making any other I2C call.
+ @param    addr      address of I2C device
+ @param    location  first register to read
+ @param    buffer    destination, must stay valid until the transfer ends
+ @param    size      number of bytes to read
+ @retval   0 transfer started
+ @retval   1 transfer already in progress
+ */
+extern unsigned char i2c_read_async(unsigned char addr, unsigned char location, uint8_t *buffer, uint8_t size);
+
+/**
+ @brief    wait for an interrupt-driven transfer, aborting it on timeout
+ @retval   0 no transfer pending or transfer completed
+ @retval   1 transfer failed or timed out
+ */
+extern unsigned char i2c_async_wait(void);
+
 /**@}*/
 #endif
@@ -101,7 +101,7 @@ enum RCchannels 	{THROTTLE = 0, AILERON, ELEVATOR, RUDDER, GEAR, AUX1, AUX2, AUX
 enum Availability	{OFF = 0, ON, SCALE, REVERSE, REVERSESCALE};
 enum Orientation	{HORIZONTAL = 0, VERTICAL, UPSIDEDOWN, AFT, SIDEWAYS, PITCHUP};
 enum KK21ADCInputs 	{AIN_VCC1 = 0, AIN_ADC1, AIN_ADC2, AIN_VBAT1, AIN_ADC4, AIN_ADC5, AIN_PITOT, AIN_ADC7};
-enum Global_Status	{IDLE = 0, REQ_STATUS, WAITING_STATUS, PRESTATUS, STATUS, WAITING_TIMEOUT, WAITING_TIMEOUT_BD, PRESTATUS_TIMEOUT, STATUS_TIMEOUT, POSTSTATUS_TIMEOUT, MENU};
+enum Global_Status	{IDLE = 0, REQ_STATUS, WAITING_STATUS, STATUS, WAITING_TIMEOUT, WAITING_TIMEOUT_BD, STATUS_TIMEOUT, MENU};
 enum Servo_rate		{LOW = 0, SYNC, FAST};
 enum TransitState	{TRANS_P1 = 0, TRANS_P1_to_P1n_start, TRANS_P1n_to_P1_start, TRANS_P1_to_P2_start, TRANS_P1n, TRANSITIONING, TRANS_P2_to_P1_start, TRANS_P1n_to_P2_start, TRANS_P2_to_P1n_start, TRANS_P2};
 //					THROTTLE, AILERON, ELEVATOR, RUDDER, GEAR, AUX1, AUX2, AUX3, ROLLGYRO, PITCHGYO, YAWGYRO, ROLLACC, PITCHACC, NONE
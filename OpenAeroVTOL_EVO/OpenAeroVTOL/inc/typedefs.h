@@ -218,6 +218,13 @@ typedef struct
 	uint16_t	y;
 } mugui_size16_t;
 
+typedef struct
+{
+	int16_t		acc[3];					// Accel X, Y, Z in chip order
+	int16_t		temperature;			// Die temperature (raw)
+	int16_t		gyro[3];				// Gyro X, Y, Z in chip order
+} sensor_sample_t;
+
 
 
 // The following code courtesy of: stu_san on AVR Freaks
@@ -82,6 +82,15 @@
 //			Added more code to stabilise loop period in high-speed mode.
 //			FAST mode now allowable for Satellite RXs.
 //			Tweaked menu beeps. Inverted cal audio confirmation.
+//			Status and idle screens now sent to the LCD one page per loop.
+//			Removed the PRESTATUS/POSTSTATUS screen states that blocked PWM output.
+//			Menus now only redraw and send the lines that have changed.
+//			Battery voltage now oversampled one conversion per loop without waiting.
+//			Gyro, temperature and acc data now read from the MPU6050 in one burst.
+//			Sensor reads now run in the background on the TWI interrupt.
+//			Added SENSOR_FIFO option to average 1kHz MPU6050 samples from its FIFO.
+//			Gyro calibration on arming now finishes as soon as the model is still.
+//			Orientation tables now copied to RAM. Added BOARD_ALIGNMENT option.
 //
 //***********************************************************
 //* Notes
@@ -114,6 +123,7 @@
 #include "rc.h"
 #include "servos.h"
 #include "vbat.h"
+#include "adc.h"
 #include "gyros.h"
 #include "init.h"
 #include "acc.h"
@@ -129,6 +139,7 @@
 #include "imu.h"
 #include "eeprom.h"
 #include "uart.h"
+#include "i2c.h"
 
 //***********************************************************
 //* Fonts
@@ -207,7 +218,6 @@ int main(void)
 	bool ServoTick = false;
 	bool ResampleRCRate = false;
 	bool PWMOverride = false;
-	bool Interrupted_Clone = false;
 	bool SlowRC = true;
 
 	// 32-bit timers
@@ -296,11 +306,12 @@ int main(void)
 		}
 
 		//************************************************************
-		//* State machine for switching between screens safely
+		//* State machine for switching between screens
 		//* Particularly in FAST mode, if anything slows down the loop
 		//* time significantly (beeps, LCD updates) the PWM generation
-		//* is at risk of corruption. To get around that, entry and exit
-		//* from special states must be handled in stages.
+		//* is at risk of corruption. The status and idle screens are
+		//* therefore only drawn into the buffer here, and the buffer
+		//* is sent to the LCD a slice at a time at the end of each loop.
 		//* In the state machine, once a state changes, the new state 
 		//* will be process in the next loop.
 		//************************************************************
@@ -313,19 +324,15 @@ int main(void)
 		switch(Menu_mode) 
 		{
 			// In IDLE mode, the text "Press for status" is displayed ONCE.
-			// If a button is pressed the mode changes to PRESTATUS, where
-			// it will wait for the right time to proceed.
+			// If a button is pressed the mode changes to STATUS.
 			case IDLE:
 				// If any button is pressed
 				if((PINB & 0xf0) != 0xf0)
 				{
-					Menu_mode = PRESTATUS;
+					Menu_mode = STATUS;
 					// Reset the status screen timeout
 					Status_seconds = 0;
 					
-					// Allow PWM output
-					PWMOverride = false;
-					
 					// When not in idle mode, enable Timer0 interrupts as loop rate 
 					// is slow and we need TMR0 to fully measure it.
 					// This may cause PWM generation interruption
@@ -340,36 +347,13 @@ int main(void)
 				}
 				break;
 
-			// Waiting to safely enter Status screen
-			// If Interrupted or Interrupted_Clone is true, data must have just completed.
-			// If Overdue is true, there is no data to interrupt.
-			// PWM activity must stop before we attempt to pop up the status screen.
-			case PRESTATUS:
-				// If interrupted, or if currently "No signal"
-				if (Interrupted || Interrupted_Clone || Overdue)
-				{
-					// Ready to move on
-					Menu_mode = STATUS;
-							
-					// Prevent PWM output
-					PWMOverride = true;		
-					
-					// Clear Interrupted_Clone
-					Interrupted_Clone = false;
-				}
-
-				break;
-
-			// Status screen first display
+			// Status screen update
 			case STATUS:
 				// Reset the status screen period
 				UpdateStatus_timer = 0;
 
-				// Update status screen
+				// Draw status screen and queue it for the LCD
 				Display_status();
-				
-				// Prevent PWM output just after updating the LCD
-				PWMOverride = true;
 
 				// Wait for timeout
 				Menu_mode = WAITING_TIMEOUT_BD;
@@ -395,10 +379,7 @@ int main(void)
 				// In status screen, change back to idle after timing out
 				if (Status_seconds >= 10)
 				{
-					Menu_mode = PRESTATUS_TIMEOUT;
-					
-					// Enable PWM output
-					PWMOverride = false;
+					Menu_mode = STATUS_TIMEOUT;
 				}
 
 				// Jump to menu if button pressed
@@ -413,82 +394,22 @@ int main(void)
 				// Update status screen four times/sec while waiting to time out
 				else if (UpdateStatus_timer > (SECOND_TIMER >> 2))
 				{
-					Menu_mode = PRESTATUS;
-
-					// Prevent PWM output
-					PWMOverride = true; // Debug - not needed yet?
-				}
-				
-				else
-				{
-					// Enable PWM output
-					PWMOverride = false;					
+					Menu_mode = STATUS;
 				}
 
 				break;
 
-			// Attempting to leave Status gracefully while PWM stopped.
-			// If Interrupted or Interrupted_Clone is true, data must have just completed.
-			// If Overdue is true, there is no data to interrupt.
-			// PWM activity must stop before we attempt to pop up the status screen.
-			case PRESTATUS_TIMEOUT:
-				// If interrupted, or if currently "No signal"
-				if (Interrupted || Interrupted_Clone || Overdue)
-				{
-					// Switch to STATUS_TIMEOUT mode
-					Menu_mode = STATUS_TIMEOUT;
-				
-					// Enable PWM output
-					PWMOverride = false;
-					
-					// Clear Interrupted_Clone
-					Interrupted_Clone = false;
-				}
-				else
-				{
-					// Prevent PWM output
-					PWMOverride = true;
-				}
-				
-				break;
-
-			// In STATUS_TIMEOUT mode, the idle screen is displayed and the mode 
-			// changed to POSTSTATUS_TIMEOUT. 
+			// In STATUS_TIMEOUT mode, the idle screen is drawn and the mode 
+			// changed to IDLE. 
 			case STATUS_TIMEOUT:
-				// Pop up the Idle screen
+				// Draw the Idle screen and queue it for the LCD
 				idle_screen();
 
 				// Switch to IDLE mode
-				Menu_mode = POSTSTATUS_TIMEOUT;
-
-				// Prevent PWM output
-				PWMOverride = true;
+				Menu_mode = IDLE;
 
 				break;
 
-			// In POSTSTATUS_TIMEOUT mode, we wait for a PWM cycle to complete
-			// The idle screen has been refreshed and we need to wait.
-			case POSTSTATUS_TIMEOUT:
-				// If interrupted, or if currently "No signal"
-				if (Interrupted || Interrupted_Clone || Overdue)
-				{
-					// Switch to IDLE mode
-					Menu_mode = IDLE;
-					
-					// Prevent PWM output
-					PWMOverride = false;
-					
-					// Clear Interrupted_Clone
-					Interrupted_Clone = false;
-				}
-				else
-				{
-					// Enable PWM output
-					PWMOverride = true;			
-				}
-				
-				break;
-
 			// In MENU mode, 
 			case MENU:
 				LVA = 0;	// Make sure buzzer is off :)
@@ -535,6 +456,9 @@ int main(void)
 			General_error &= ~(1 << NO_SIGNAL);		// Clear NO_SIGNAL bit
 		}
 
+		// Collect last loop's battery conversion and start the next
+		sample_adc();
+
 		// Beep buzzer if Vbat lower than trigger		
 		if (GetVbat() < Config.PowerTriggerActual)
 		{
@@ -1195,14 +1119,8 @@ int main(void)
 				}
 
 				// If not, block the RC interrupts until we run out of pulses
-				// We need to cancel the Interrupted flag but have to make a copy until 
-				// the status screen state machine has seen it.
 				else
 				{
-					if (Interrupted)
-					{
-						Interrupted_Clone = true;	// Hand "Interrupted" baton on to its clone
-					}
 					Interrupted = false;		// Cancel pending interrupts
 					Disable_RC_Interrupts();	// Disable RC interrupts
 					RCInterruptsON = false;		// Flag it for the rest of the code
@@ -1230,11 +1148,7 @@ int main(void)
 			//* High speed in FAST mode
 			//******************************************************************
 
-			if (Interrupted)
-			{
-				Interrupted_Clone = true;	// Hand "Interrupted" baton on to its clone
-				Interrupted = false;		// Reset interrupted flag if that was the cause of entry			
-			}
+			Interrupted = false;			// Reset interrupted flag if that was the cause of entry
 
 			// Decide which outputs fire this time, depending on their device setting (A.Servo, D.Servo, Motor)
 			// D.Servo, Motor are always ready, but A.Servo must be limited to Servo_rate, flagged by ServoTick
@@ -1305,6 +1219,11 @@ int main(void)
 				output_servo_ppm(ServoFlag);		// Output servo signal			
 			}
 
+			// Start the next sensor read now that PWM generation is over. 
+			// The TWI interrupt transfers the data while the rest of this loop and 
+			// the start of the next one run, and ReadGyros() collects it.
+			start_sensor_read();
+
 
 			// Decrement PWM pulse sum
 			if ((Config.Servo_rate == FAST) && (PWM_pulses > 0))
@@ -1335,15 +1254,21 @@ int main(void)
 		}
 		
 		//************************************************************
-		//* Carefully update idle screen if error level changed
+		//* Send the next slice of any pending LCD update
+		//************************************************************
+
+		flush_buffer_tick(LCD_FLUSH_BYTES);
+
+		//************************************************************
+		//* Update idle screen if error level changed
 		//************************************************************	
 
 		// Only update idle when error state has changed.
 		// This prevents the continual updating of the LCD disrupting the FC
 		if ((old_alarms != General_error) && (Menu_mode == IDLE))
 		{
-			// Force safe update of idle screen
-			Menu_mode = PRESTATUS_TIMEOUT;
+			// Redraw the idle screen next loop
+			Menu_mode = STATUS_TIMEOUT;
 		}
 			
 		// Save current alarm state into old_alarms
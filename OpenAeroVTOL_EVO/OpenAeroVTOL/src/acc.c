@@ -24,6 +24,7 @@
 #include "MPU6050.h"
 #include "imu.h"
 #include "menu_ext.h"
+#include "gyros.h"
 
 //************************************************************
 // Prototypes
@@ -32,6 +33,7 @@
 void ReadAcc(void);
 void CalibrateAcc(int8_t type);
 void get_raw_accs(void);
+void update_acc_orientation(void);
 
 //************************************************************
 // Defines
@@ -76,6 +78,11 @@ const int8_t Acc_Pol[NUMBEROFORIENTS][NUMBEROFAXIS] PROGMEM =
 int16_t accADC[NUMBEROFAXIS];	// Holds Acc ADC values - always in RPY order
 int16_t accVert = 0;			// Holds the level-zeroed Z-acc value. Used for height damping in hover only.
 
+// Orientation tables copied out of PROGMEM for the current Config.Orientation
+int8_t	AccOrder[NUMBEROFAXIS];	// ACC_RPY_Order[]
+bool	AccNegate[NUMBEROFAXIS];// Acc_Pol[] is -1
+int8_t	AccOrientation = -1;	// Orientation the tables were made for
+
 void ReadAcc()
 {
 	uint8_t i;
@@ -102,7 +109,10 @@ void ReadAcc()
 		accADC[i] -= Config.AccZero[i];
 
 		// Change polarity
-		accADC[i] *= (int8_t)pgm_read_byte(&Acc_Pol[Config.Orientation][i]);
+		if (AccNegate[i])
+		{
+			accADC[i] = -accADC[i];
+		}
 	}
 
 	// Recalculate current accVert using filtered acc value
@@ -111,6 +121,20 @@ void ReadAcc()
 	 accVert = accSmooth[YAW] + (Config.AccZeroNormZ - Config.AccZero[YAW]);
 }
 
+// Copy the orientation tables into RAM when the orientation changes
+void update_acc_orientation(void)
+{
+	uint8_t i;
+
+	for (i=0; i<NUMBEROFAXIS; i++)
+	{
+		AccOrder[i] = (int8_t)pgm_read_byte(&ACC_RPY_Order[Config.Orientation][i]);
+		AccNegate[i] = ((int8_t)pgm_read_byte(&Acc_Pol[Config.Orientation][i]) < 0);
+	}
+
+	AccOrientation = Config.Orientation;
+}
+
 //***************************************************************
 // Fill accADC with RPY data appropriate to the board orientation
 //***************************************************************
@@ -118,35 +142,43 @@ void ReadAcc()
 void get_raw_accs(void)
 {
 	int16_t RawADC[NUMBEROFAXIS];
+	int16_t *acc;
 	uint8_t i;
+#ifdef BOARD_ALIGNMENT
+	int16_t aligned[NUMBEROFAXIS];
+#endif
 
-	// Get data from MPU6050
-	uint8_t Accs[6];
-	int16_t temp1, temp2;
-
-	// Get the i2c data from the MPU6050
-	readI2CbyteArray(MPU60X0_DEFAULT_ADDRESS,MPU60X0_RA_ACCEL_XOUT_H,(uint8_t *)Accs,6);
-
-	// Reassemble data into accADC array and down sample to reduce resolution and noise
-	// This notation is true to the chip, but not the board orientation
+	if (Config.Orientation != AccOrientation)
+	{
+		update_acc_orientation();
+	}
 
-	temp1 = Accs[0] << 8;					// Accel X
-	temp2 = Accs[1];
-	RawADC[ROLL] = (temp1 + temp2) >> 6;
+	// Get new data from the MPU6050 unless the last burst read has not been used yet
+	// In the main loop ReadGyros() does the read and this just uses the same sample
+	if (!(SensorSampleFresh & SAMPLE_ACC))
+	{
+		read_sensors();
+	}
+	SensorSampleFresh &= ~SAMPLE_ACC;
 
-	temp1 = Accs[2] << 8;					// Accel Y
-	temp2 = Accs[3];
-	RawADC[PITCH] = -((temp1 + temp2) >> 6);
+#ifdef BOARD_ALIGNMENT
+	align_sensor_vector(SensorSample.acc, aligned);
+	acc = aligned;
+#else
+	acc = SensorSample.acc;
+#endif
 
-	temp1 = Accs[4] << 8;					// Accel Z
-	temp2 = Accs[5];
-	RawADC[YAW] = (temp1 + temp2) >> 6;
+	// Down sample to reduce resolution and noise
+	// This notation is true to the chip, but not the board orientation
+	RawADC[ROLL] = acc[0] >> 6;				// Accel X
+	RawADC[PITCH] = -(acc[1] >> 6);			// Accel Y
+	RawADC[YAW] = acc[2] >> 6;				// Accel Z
 
 	// Reorient the data as per the board orientation	
 	for (i=0; i<NUMBEROFAXIS; i++)
 	{
 		// Rearrange the sensors
-		accADC[i] = RawADC[(int8_t)pgm_read_byte(&ACC_RPY_Order[Config.Orientation][i])];
+		accADC[i] = RawADC[AccOrder[i]];
 	}
 }
 
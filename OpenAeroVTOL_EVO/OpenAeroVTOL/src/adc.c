@@ -1,5 +1,13 @@
 //***********************************************************
 //* adc.c
+//*
+//* The ADC is sampled without interrupts, so that nothing can
+//* fire during the cycle-counted servo output. sample_adc() is
+//* called once per main loop. It collects the conversion started
+//* on the previous loop and starts the next one. It sums 
+//* ADC_OVERSAMPLE conversions per channel, then low-pass filters
+//* the sum into ADC_Filtered[] before moving on to the next 
+//* channel in ADC_Channels[].
 //***********************************************************
 
 //***********************************************************
@@ -7,6 +15,9 @@
 //***********************************************************
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "io_cfg.h"
+#include "adc.h"
 
 //************************************************************
 // Prototypes
@@ -14,6 +25,24 @@
 
 void Init_ADC(void);
 void read_adc(uint8_t channel);
+void sample_adc(void);
+uint16_t get_adc_filtered(uint8_t slot);
+
+//************************************************************
+// Defines
+//************************************************************
+
+// Channels sampled in the background, in slot order
+const uint8_t ADC_Channels[ADC_CHANNELS] PROGMEM = {AIN_VBAT1};
+
+//************************************************************
+// Variables
+//************************************************************
+
+uint16_t ADC_Filtered[ADC_CHANNELS];	// Filtered ADC values, scaled by ADC_OVERSAMPLE
+uint16_t adc_sum;						// Sum of conversions for the current channel
+uint8_t adc_count;						// Number of conversions in adc_sum
+uint8_t adc_slot;						// Current slot in ADC_Channels[]
 
 //***********************************************************
 // ADC subroutines
@@ -21,13 +50,66 @@ void read_adc(uint8_t channel);
 
 void Init_ADC(void)
 {
+	uint8_t i;
+
 	// Digital Input Disable Register - ADC0~7 Digital Input Disable
 	DIDR0 	= (1<<ADC0D)|(1<<ADC1D)|(1<<ADC2D)|(1<<ADC3D)|(1<<ADC4D)|(1<<ADC5D)|(1<<ADC6D)|(1<<ADC7D);
-	
+
+	// Seed each filter with a single blocking conversion so that
+	// values are valid before the first oversampled block completes
+	for (i = 0; i < ADC_CHANNELS; i++)
+	{
+		read_adc(pgm_read_byte(&ADC_Channels[i]));
+		ADC_Filtered[i] = ADCW * ADC_OVERSAMPLE;
+	}
+
+	adc_slot = 0;
+	adc_count = 0;
+	adc_sum = 0;
+
 	// ADC Control and Status Register B - ADTS2:0
 	ADCSRB 	= 0x00;
+
+	// Start the first conversion for sample_adc() to collect
+	ADMUX	= pgm_read_byte(&ADC_Channels[0]);
+	ADCSRA 	= (1<<ADEN)|(1<<ADSC)|(1<<ADPS1)|(1<<ADPS2);
+}
+
+// Collect the last conversion and start the next. Call once per loop.
+// A conversion takes about 42us, well under a loop, so it is normally 
+// complete by the next call. If not it is simply left until then.
+void sample_adc(void)
+{
+	if (ADCSRA & (1 << ADSC))
+	{
+		return;
+	}
+
+	adc_sum += ADCW;
+	adc_count++;
+
+	// Block of samples complete - filter and move to next channel
+	if (adc_count >= ADC_OVERSAMPLE)
+	{
+		ADC_Filtered[adc_slot] += ((int16_t)(adc_sum - ADC_Filtered[adc_slot])) >> ADC_FILTER_SHIFT;
+
+		adc_sum = 0;
+		adc_count = 0;
+
+		adc_slot++;
+		if (adc_slot >= ADC_CHANNELS)
+		{
+			adc_slot = 0;
+		}
+
+		ADMUX = pgm_read_byte(&ADC_Channels[adc_slot]);
+	}
+
+	// ADEN, ADSC, ADPS1,2
+	ADCSRA 	= (1<<ADEN)|(1<<ADSC)|(1<<ADPS1)|(1<<ADPS2);
 }
 
+// Blocking single conversion. Only used by Init_ADC().
 void read_adc(uint8_t channel)
 {
 	ADMUX	= channel;
@@ -39,4 +121,9 @@ void read_adc(uint8_t channel)
 	while (ADCSRA & (1 << ADSC));
 }
 
+// Return the filtered value for a slot, scaled by ADC_OVERSAMPLE
+uint16_t get_adc_filtered(uint8_t slot)
+{
+	return ADC_Filtered[slot];
+}
 
@@ -149,7 +149,7 @@ void Display_status(void)
 		}
 	}
 
-	// Write buffer to complete
-	write_buffer(buffer);
-	clear_buffer(buffer);
+	// Queue the buffer for writing. The main loop sends it a page or so at a time
+	// so the buffer must be left intact until the flush is complete.
+	flush_buffer_start(buffer, LCD_ALL_PAGES);
 }
@@ -30,6 +30,7 @@
 
 #include <avr/io.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
 #include <util/delay.h>
 #include <avr/pgmspace.h> 
@@ -41,7 +42,22 @@ void glcd_delay(void);
 void glcd_delay_1us(void);
 void glcd_spiwrite_asm(uint8_t byte);
 void write_buffer(uint8_t *buffer);
+void write_buffer_pages(uint8_t *buffer, uint8_t pages);
+void flush_buffer_start(uint8_t *buffer, uint8_t pages);
+bool flush_buffer_tick(uint16_t bytes);
+void clear_buffer_pages(uint8_t *buff, uint8_t pages);
+uint8_t lcd_page_mask(uint8_t y, uint8_t h);
 void clear_screen(void);
+
+//***********************************************************
+//* Variables
+//***********************************************************
+
+uint8_t *flush_source;				// Buffer being flushed
+uint8_t flush_pages = 0;			// Bitmask of buffer pages still to be sent
+uint8_t flush_page = 0;				// Buffer page currently being sent
+uint8_t flush_column = 0;			// Next column to send in flush_page
+bool menu_buffer_valid = false;		// Set when the buffer holds the menu list last drawn. Cleared by clear_buffer().
 
 //***********************************************************
 //* Low-level code
@@ -114,27 +130,122 @@ void st7565_set_brightness(uint8_t val)
 }
 
 // Write LCD buffer
-void write_buffer(uint8_t *buffer) 
+// Any background flush in progress is overtaken by this full write
+void write_buffer(uint8_t *buffer)
+{
+	flush_buffer_start(buffer, LCD_ALL_PAGES);
+	flush_buffer_tick(LCD_BUFFER_SIZE);
+}
+
+// Write only the selected pages of the LCD buffer (bit n = buffer page n)
+void write_buffer_pages(uint8_t *buffer, uint8_t pages)
+{
+	flush_buffer_start(buffer, pages);
+	flush_buffer_tick(LCD_BUFFER_SIZE);
+}
+
+//***********************************************************
+//* Incremental buffer flush
+//*
+//* A full frame is 1024 bytes of bit-banged SPI, which takes
+//* longer than a whole PWM cycle. flush_buffer_start() marks
+//* the pages to be sent and flush_buffer_tick() then sends a
+//* limited number of bytes each time it is called, so that the
+//* main loop can spread an update over several passes.
+//***********************************************************
+
+// Request a flush of the selected pages (bit n = buffer page n)
+void flush_buffer_start(uint8_t *buffer, uint8_t pages)
+{
+	// Restart any page that was already part-written
+	if (flush_pages & (1 << flush_page))
+	{
+		flush_column = 0;
+	}
+
+	flush_source = buffer;
+	flush_pages |= pages;
+}
+
+// Send up to "bytes" bytes of pending data. Returns true when no more data is pending.
+bool flush_buffer_tick(uint16_t bytes)
 {
-	uint8_t c, p;
-	for(p = 0; p < 8; p++) 
+	uint8_t *data;
+
+	while (flush_pages && bytes)
 	{
-		st7565_command(CMD_SET_PAGE | (uint8_t)pgm_read_byte(&pagemap[p]));		// Page 7 to 0
-		st7565_command(CMD_SET_COLUMN_LOWER | (0x0 & 0xf));						// Column 0
-		st7565_command(CMD_SET_COLUMN_UPPER | ((0x0 >> 4) & 0xf));				// Column 0
-		st7565_command(CMD_RMW);												// Sets auto-increment
+		// Find the next page to send
+		while ((flush_pages & (1 << flush_page)) == 0)
+		{
+			flush_page = (flush_page + 1) & 7;
+			flush_column = 0;
+		}
+
+		// Set the address each time as other LCD commands may have been sent since the last tick
+		st7565_command(CMD_SET_PAGE | (uint8_t)pgm_read_byte(&pagemap[flush_page]));	// Page 7 to 0
+		st7565_command(CMD_SET_COLUMN_LOWER | (flush_column & 0xf));					// Column
+		st7565_command(CMD_SET_COLUMN_UPPER | ((flush_column >> 4) & 0xf));				// Column
+		st7565_command(CMD_RMW);														// Sets auto-increment
 
-		for(c = 0; c < 128; c++) 
+		data = &flush_source[(LCDWIDTH * flush_page) + flush_column];
+
+		while ((flush_column < LCDWIDTH) && bytes)
+		{
+			st7565_data(*data++);
+			flush_column++;
+			bytes--;
+		}
+
+		// Page complete
+		if (flush_column >= LCDWIDTH)
 		{
-			st7565_data(buffer[(128*p)+c]);
+			flush_pages &= ~(1 << flush_page);
+			flush_page = (flush_page + 1) & 7;
+			flush_column = 0;
 		}
 	}
+
+	return (flush_pages == 0);
 }
 
 // Clear buffer
 void clear_buffer(uint8_t *buff) 
 {
 	memset(buff, 0, 1024);
+	menu_buffer_valid = false;
+}
+
+// Clear selected pages of the buffer (bit n = buffer page n)
+void clear_buffer_pages(uint8_t *buff, uint8_t pages)
+{
+	uint8_t p;
+
+	for (p = 0; p < (LCDHEIGHT / 8); p++)
+	{
+		if (pages & (1 << p))
+		{
+			memset(&buff[LCDWIDTH * p], 0, LCDWIDTH);
+		}
+	}
+}
+
+// Return the mask of buffer pages touched by rows y to y+h-1
+uint8_t lcd_page_mask(uint8_t y, uint8_t h)
+{
+	uint8_t p;
+	uint8_t pages = 0;
+
+	if ((h == 0) || (y >= LCDHEIGHT))
+	{
+		return 0;
+	}
+
+	for (p = (y >> 3); (p <= ((y + h - 1) >> 3)) && (p < (LCDHEIGHT / 8)); p++)
+	{
+		pages |= (1 << p);
+	}
+
+	return pages;
 }
 
 // Clear screen (does not clear buffer)
@@ -228,14 +339,37 @@ void drawline(uint8_t *buff, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uin
 }
 
 // Filled rectangle
+// Works a page byte at a time. The top row of each page is bit 7.
 void fillrect(uint8_t *buff, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) 
 {
-	// Stupidest version - just pixels - but fast with internal buffer!
-	for (uint8_t i=x; i<x+w; i++) 
+	uint8_t i, p, mask, first, last, x_end, y_end;
+
+	if ((x >= LCDWIDTH) || (y >= LCDHEIGHT) || (w == 0) || (h == 0))
 	{
-		for (uint8_t j=y; j<y+h; j++) 
+		return;
+	}
+
+	// Clip to the screen
+	x_end = ((x + w) > LCDWIDTH) ? LCDWIDTH : (x + w);
+	y_end = ((y + h) > LCDHEIGHT) ? (LCDHEIGHT - 1) : (y + h - 1);
+
+	for (p = (y >> 3); p <= (y_end >> 3); p++)
+	{
+		// Rows of this page inside the rectangle
+		first = (p == (y >> 3)) ? (y & 7) : 0;
+		last = (p == (y_end >> 3)) ? (y_end & 7) : 7;
+		mask = (uint8_t)(0xff >> first) & (uint8_t)(0xff << (7 - last));
+
+		for (i = x; i < x_end; i++)
 		{
-			setpixel(buff, i, j, color);
+			if (color)
+			{
+				buff[i + (p * LCDWIDTH)] |= mask;
+			}
+			else
+			{
+				buff[i + (p * LCDWIDTH)] &= ~mask;
+			}
 		}
 	}
 }
@@ -518,5 +518,6 @@ void idle_screen(void)
 		LCD_Display_Text(138,(const unsigned char*)Verdana14,28,43);// "(Armed)"
 	}
 
-	write_buffer(buffer);
+	// Queue the buffer for writing by the main loop
+	flush_buffer_start(buffer, LCD_ALL_PAGES);
 }
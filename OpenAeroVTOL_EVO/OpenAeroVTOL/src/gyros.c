@@ -23,6 +23,10 @@
 #include "main.h"
 #include "imu.h"
 #include "eeprom.h"
+#include "gyros.h"
+#ifdef BOARD_ALIGNMENT
+#include <math.h>
+#endif
 
 //************************************************************
 // Prototypes
@@ -32,6 +36,9 @@ void ReadGyros(void);
 void CalibrateGyrosFast(void);
 bool CalibrateGyrosSlow(void);
 void get_raw_gyros(void);
+void update_gyro_orientation(void);
+void init_board_alignment(void);
+void align_sensor_vector(const int16_t *in, int16_t *out);
 
 //************************************************************
 // Defines
@@ -40,12 +47,18 @@ void get_raw_gyros(void);
 #define CAL_TIMEOUT	5				// Calibration timeout
 #define GYRODIV	4					// Divide by 16 for 2000 deg/s
 
-#define CAL_STABLE_TIME 200			// Calibration stable timeout
-#define GYROS_STABLE 1				// Minimum gyro error
+#define CAL_WINDOW 64				// Samples per calibration window
+#define CAL_WINDOW_SHIFT 6			// log2(CAL_WINDOW)
+#define CAL_STABLE_WINDOWS 3		// Number of still windows in a row needed
+#define CAL_VARIANCE 4				// Max variance per window (about 2 deg/s standard deviation)
+#define CAL_DRIFT 2					// Max change in mean between windows
+#define CAL_DIFF_LIMIT 255			// Limit on each sample's difference from the reference
 #define SECOND_TIMER 19531			// Unit of timing for seconds
 #define GYROFS2000DEG 0x18			// 2000 deg/s full scale
 #define GYROFS500DEG 0x08			// 500 deg/s full scale
 #define GYROFS250DEG 0x00			// 250 deg/s full scale
+#define ALIGN_ONE 16384				// 1.0 in the board alignment matrix
+#define ALIGN_SHIFT 14
 
 //***********************************************************
 // ROLL, PITCH, YAW mapping for alternate orientation modes
@@ -81,6 +94,15 @@ const int8_t Gyro_Pol[NUMBEROFORIENTS][NUMBEROFAXIS] PROGMEM =
 
 int16_t gyroADC[NUMBEROFAXIS];			// Holds Gyro ADCs
 
+// Orientation tables copied out of PROGMEM for the current Config.Orientation
+int8_t	GyroOrder[NUMBEROFAXIS];		// Gyro_RPY_Order[]
+bool	GyroNegate[NUMBEROFAXIS];		// Gyro_Pol[] is -1
+int8_t	GyroOrientation = -1;			// Orientation the tables were made for
+
+#ifdef BOARD_ALIGNMENT
+int16_t BoardAlignment[NUMBEROFAXIS][NUMBEROFAXIS];	// Fine alignment rotation, ALIGN_ONE = 1.0
+#endif
+
 void ReadGyros(void)					// Conventional orientation
 {
 	uint8_t i;
@@ -93,41 +115,132 @@ void ReadGyros(void)					// Conventional orientation
 		gyroADC[i] -= Config.gyroZero[i];
 
 		// Change polarity
-		gyroADC[i] *= (int8_t)pgm_read_byte(&Gyro_Pol[Config.Orientation][i]);
+		if (GyroNegate[i])
+		{
+			gyroADC[i] = -gyroADC[i];
+		}
 	}
 }
 
+// Copy the orientation tables into RAM when the orientation changes
+void update_gyro_orientation(void)
+{
+	uint8_t i;
+
+	for (i=0; i<NUMBEROFAXIS; i++)
+	{
+		GyroOrder[i] = (int8_t)pgm_read_byte(&Gyro_RPY_Order[Config.Orientation][i]);
+		GyroNegate[i] = ((int8_t)pgm_read_byte(&Gyro_Pol[Config.Orientation][i]) < 0);
+	}
+
+	GyroOrientation = Config.Orientation;
+}
+
 void get_raw_gyros(void)
 {
 	int16_t RawADC[NUMBEROFAXIS];
+	int16_t *gyro;
 	uint8_t i;
-	uint8_t Gyros[6];
-	int16_t temp1, temp2;
+#ifdef BOARD_ALIGNMENT
+	int16_t aligned[NUMBEROFAXIS];
+#endif
 
-	// Get the i2c data from the MPU6050
-	readI2CbyteArray(MPU60X0_DEFAULT_ADDRESS,MPU60X0_RA_GYRO_XOUT_H,(uint8_t *)Gyros,6);
+	if (Config.Orientation != GyroOrientation)
+	{
+		update_gyro_orientation();
+	}
 
-	// Reassemble data into gyroADC array and down-sample to reduce resolution and noise
-	temp1 = Gyros[0] << 8;
-	temp2 = Gyros[1];
-	RawADC[PITCH] = (temp1 + temp2) >> GYRODIV;
+	// Get new data from the MPU6050 unless the last burst read has not been used yet
+	if (!(SensorSampleFresh & SAMPLE_GYRO))
+	{
+		read_sensors();
+	}
+	SensorSampleFresh &= ~SAMPLE_GYRO;
 
-	temp1 = Gyros[2] << 8;
-	temp2 = Gyros[3];
-	RawADC[ROLL] = (temp1 + temp2) >> GYRODIV;
+#ifdef BOARD_ALIGNMENT
+	align_sensor_vector(SensorSample.gyro, aligned);
+	gyro = aligned;
+#else
+	gyro = SensorSample.gyro;
+#endif
 
-	temp1 = Gyros[4] << 8;
-	temp2 = Gyros[5];
-	RawADC[YAW] = (temp1 + temp2) >> GYRODIV;
+	// Down-sample to reduce resolution and noise
+	RawADC[PITCH] = gyro[0] >> GYRODIV;
+	RawADC[ROLL] = gyro[1] >> GYRODIV;
+	RawADC[YAW] = gyro[2] >> GYRODIV;
 
 	// Reorient the data as per the board orientation	
 	for (i=0; i<NUMBEROFAXIS; i++)
 	{
 		// Rearrange the sensors
-		gyroADC[i] 	= RawADC[(int8_t)pgm_read_byte(&Gyro_RPY_Order[Config.Orientation][i])];
+		gyroADC[i] 	= RawADC[GyroOrder[i]];
 	}
 }
 
+#ifdef BOARD_ALIGNMENT
+//***************************************************************
+// Board fine alignment
+// Both the gyro and acc data are rotated in the MPU6050's own 
+// X/Y/Z frame, before being rearranged for the board orientation.
+//***************************************************************
+
+// Work out the rotation matrix once at start-up
+void init_board_alignment(void)
+{
+	float	sr, cr, sp, cp, sy, cy;
+	float	m[NUMBEROFAXIS][NUMBEROFAXIS];
+	uint8_t i, j;
+
+	sr = sin(ALIGN_ROLL * (M_PI / 180.0));		// About Y
+	cr = cos(ALIGN_ROLL * (M_PI / 180.0));
+	sp = sin(ALIGN_PITCH * (M_PI / 180.0));		// About X
+	cp = cos(ALIGN_PITCH * (M_PI / 180.0));
+	sy = sin(ALIGN_YAW * (M_PI / 180.0));		// About Z
+	cy = cos(ALIGN_YAW * (M_PI / 180.0));
+
+	// R = Rz(yaw) x Ry(roll) x Rx(pitch)
+	m[0][0] = cy * cr;
+	m[0][1] = (cy * sr * sp) - (sy * cp);
+	m[0][2] = (cy * sr * cp) + (sy * sp);
+	m[1][0] = sy * cr;
+	m[1][1] = (sy * sr * sp) + (cy * cp);
+	m[1][2] = (sy * sr * cp) - (cy * sp);
+	m[2][0] = -sr;
+	m[2][1] = cr * sp;
+	m[2][2] = cr * cp;
+
+	for (i = 0; i < NUMBEROFAXIS; i++)
+	{
+		for (j = 0; j < NUMBEROFAXIS; j++)
+		{
+			BoardAlignment[i][j] = (int16_t)lround(m[i][j] * ALIGN_ONE);
+		}
+	}
+}
+
+// Rotate one X/Y/Z sensor vector
+void align_sensor_vector(const int16_t *in, int16_t *out)
+{
+	int32_t temp32;
+	uint8_t i;
+
+	for (i = 0; i < NUMBEROFAXIS; i++)
+	{
+		temp32 = ((int32_t)BoardAlignment[i][0] * in[0]) +
+				 ((int32_t)BoardAlignment[i][1] * in[1]) +
+				 ((int32_t)BoardAlignment[i][2] * in[2]);
+
+		temp32 = temp32 >> ALIGN_SHIFT;
+
+		// A full-scale reading on more than one axis can rotate out of range
+		if (temp32 > 32767) temp32 = 32767;
+		if (temp32 < -32768) temp32 = -32768;
+
+		out[i] = (int16_t)temp32;
+	}
+}
+#endif
+
 //***************************************************************
 // Calibration routines
 //***************************************************************
@@ -158,27 +271,43 @@ void CalibrateGyrosFast(void)
 	Save_Config_to_EEPROM();
 }
 
+//***************************************************************
+// Calibrate the gyros once the model is still
+//
+// Gyro readings are collected in windows of CAL_WINDOW samples. 
+// For each window the variance is worked out from the sum and sum 
+// of squares of each reading's difference from a reference (the 
+// previous window's mean), which keeps everything in integers.
+// The zeros are taken once CAL_STABLE_WINDOWS windows in a row 
+// have a low variance and agree with each other.
+//***************************************************************
+
 bool CalibrateGyrosSlow(void)
 {
-	float 		GyroSmooth[NUMBEROFAXIS];
-	int16_t		GyroOld[NUMBEROFAXIS] = {0,0,0};
-	uint16_t	Stable_counter = 0;	
+	int16_t		ref[NUMBEROFAXIS];			// Reference for each window (previous window's mean)
+	int32_t		sum[NUMBEROFAXIS];			// Sum of differences from ref
+	uint32_t	sumsq[NUMBEROFAXIS];		// Sum of squared differences from ref
+	int16_t		diff;
+	int16_t		mean;
+	uint8_t		samples = 0;
+	uint8_t		stable_windows = 0;
 	uint16_t	Gyro_timeout = 0;
 	uint8_t		axis;
 	uint8_t		Gyro_seconds = 0;
 	uint8_t		Gyro_TCNT2 = 0;
 	bool		Gyros_Stable = false;
+	bool		window_ok;
+
+	// Start with the first reading as the reference
+	get_raw_gyros();
 
-	// Populate Config.gyroZero[] with ballpark figures
-	// This makes slow calibrate on much faster
-	CalibrateGyrosFast();	
-	
-	// Optimise starting point for each board
 	for (axis = 0; axis < NUMBEROFAXIS; axis++)
 	{
-		GyroSmooth[axis] = Config.gyroZero[axis];			
+		ref[axis] = gyroADC[axis];
+		sum[axis] = 0;
+		sumsq[axis] = 0;
 	}
-	
+
 	// Wait until gyros stable. Timeout after CAL_TIMEOUT seconds
 	while (!Gyros_Stable && ((Gyro_seconds <= CAL_TIMEOUT)))
 	{
@@ -195,35 +324,79 @@ bool CalibrateGyrosSlow(void)
 
 		get_raw_gyros();
 
-		// Calculate very long rolling average
 		for (axis = 0; axis < NUMBEROFAXIS; axis++) 
 		{
-			GyroSmooth[axis] = ((GyroSmooth[axis] * (float)999) + (float)(gyroADC[axis])) / (float)1000;
-			
-			// See if changing
-			if (GyroOld[axis] != (int16_t)GyroSmooth[axis])
-			{
-				Gyros_Stable = false;
-				Stable_counter = 0;
-			}
-		
-			// Save old reading
-			GyroOld[axis] = (int16_t)GyroSmooth[axis];
+			// Limit the difference so that the sums cannot overflow while moving
+			diff = gyroADC[axis] - ref[axis];
+
+			if (diff > CAL_DIFF_LIMIT) diff = CAL_DIFF_LIMIT;
+			if (diff < -CAL_DIFF_LIMIT) diff = -CAL_DIFF_LIMIT;
+
+			sum[axis] += diff;
+			sumsq[axis] += (uint32_t)((int32_t)diff * diff);
 		}
-		
-		// Increment stable counter to measure how long we are still
-		Stable_counter++;
-		
-		// If stable for 5 seconds, do a quick calibrate
-		if (Stable_counter > CAL_STABLE_TIME)
+
+		samples++;
+
+		// Window complete
+		if (samples >= CAL_WINDOW)
 		{
-			Gyros_Stable = true;	
-			CalibrateGyrosFast();		
+			window_ok = true;
+
+			for (axis = 0; axis < NUMBEROFAXIS; axis++) 
+			{
+				// N x N x variance = N x sum of squares - sum x sum
+				if (((CAL_WINDOW * sumsq[axis]) - (uint32_t)(sum[axis] * sum[axis])) > ((uint32_t)CAL_VARIANCE * CAL_WINDOW * CAL_WINDOW))
+				{
+					window_ok = false;
+				}
+
+				// Mean of this window must match the last one
+				mean = (int16_t)(sum[axis] >> CAL_WINDOW_SHIFT);
+
+				if ((mean > CAL_DRIFT) || (mean < -CAL_DRIFT))
+				{
+					window_ok = false;
+				}
+
+				// Next window is measured relative to this window's mean
+				ref[axis] += mean;
+				sum[axis] = 0;
+				sumsq[axis] = 0;
+			}
+
+			samples = 0;
+
+			if (window_ok)
+			{
+				stable_windows++;
+			}
+			else
+			{
+				stable_windows = 0;
+			}
+
+			// Still for long enough - use the last window's means
+			if (stable_windows >= CAL_STABLE_WINDOWS)
+			{
+				Gyros_Stable = true;
+
+				for (axis = 0; axis < NUMBEROFAXIS; axis++) 
+				{
+					Config.gyroZero[axis] = ref[axis];
+				}
+
+				Save_Config_to_EEPROM();
+			}
 		}
-		
+
 		_delay_ms(1);
+	}
 
-		// Otherwise the original saved values are used
+	// If the model never settled, fall back to a quick average as before
+	if (!Gyros_Stable)
+	{
+		CalibrateGyrosFast();
 	}
 	
 	// Return success or failure
@@ -242,9 +415,8 @@ void init_i2c_gyros(void)
 	// Make INT pin open-drain so that we can connect it straight to the MPU
 	writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_INT_PIN_CFG, 0x40);			// INT output is open-drain
 	
-	// MPU6050's internal LPF. Values are 0x06 = 5Hz, (5)10Hz, (4)21Hz, (3)44Hz, (2)94Hz, (1)184Hz LPF, (0)260Hz
-	// Software's values are 0 to 6 = 5Hz to 260Hz, so numbering is reversed here.
-	writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_CONFIG, (6 - Config.MPU6050_LPF));
+	// MPU6050's internal LPF, plus the sample rate and FIFO if used
+	set_sensor_rate();
 	
 	// Now configure gyros
 	writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_GYRO_CONFIG, GYROFS2000DEG);	// 2000 deg/sec
@@ -10,6 +10,11 @@
 #include "io_cfg.h"
 #include "i2cmaster.h"
 #include "compiledefs.h"
+#include "MPU6050.h"
+#include "i2c.h"
+#include <stdbool.h>
+#include <string.h>
+#include <avr/pgmspace.h>
 
 //************************************************************
 // Prototypes
@@ -17,6 +22,43 @@
 
 void writeI2Cbyte(uint8_t address, uint8_t location, uint8_t value);
 void readI2CbyteArray(uint8_t address, uint8_t location, uint8_t *array,uint8_t size);
+void read_sensors(void);
+void start_sensor_read(void);
+void set_sensor_rate(void);
+uint8_t read_fifo_count(void);
+void average_fifo(uint8_t samples);
+
+//************************************************************
+// Defines
+//************************************************************
+
+#define SENSOR_SAMPLE_SIZE	14			// Bytes per sample, both in the registers and the FIFO
+#define FIFO_MAX_SAMPLES	16			// Max samples averaged per read
+#define FIFO_ENABLE_ALL		0xF8		// Temperature, gyro X, Y, Z and accel into the FIFO
+#define FIFO_RUN			((1 << MPU60X0_USERCTRL_FIFO_EN_BIT) | (1 << MPU60X0_USERCTRL_FIFO_RESET_BIT))
+
+#ifdef SENSOR_FIFO
+// 4096/n for averaging n samples without a division
+const uint16_t FifoReciprocal[FIFO_MAX_SAMPLES + 1] PROGMEM = 
+{
+	0, 4096, 2048, 1365, 1024, 819, 683, 585, 512, 455, 410, 372, 341, 315, 293, 273, 256
+};
+#endif
+
+//************************************************************
+// Globals
+//************************************************************
+
+sensor_sample_t SensorSample;				// Last burst read from the MPU6050
+uint8_t SensorSampleFresh = 0;				// SAMPLE_GYRO/SAMPLE_ACC set until each part is used
+
+#ifdef SENSOR_FIFO
+static uint8_t SensorData[SENSOR_SAMPLE_SIZE * FIFO_MAX_SAMPLES];	// Raw burst data
+static uint8_t FifoSamples = 0;				// Number of FIFO samples in SensorData
+#else
+static uint8_t SensorData[SENSOR_SAMPLE_SIZE];	// Raw burst data
+#endif
+static bool SensorReadPending = false;		// Interrupt-driven read started by start_sensor_read()
 
 //************************************************************
 // Code
@@ -24,6 +66,9 @@ void readI2CbyteArray(uint8_t address, uint8_t location, uint8_t *array,uint8_t
 
 void writeI2Cbyte(uint8_t address, uint8_t location, uint8_t value)
 {
+	// Let any interrupt-driven read finish first
+	i2c_async_wait();
+
     i2c_start_wait(address+I2C_WRITE);				// Set up device address 
     i2c_write(location);							// Set up register address 
     i2c_write(value); 								// Write byte
@@ -34,6 +79,9 @@ void readI2CbyteArray(uint8_t address, uint8_t location, uint8_t *array,uint8_t
 {
 	int i=0;
 
+	// Let any interrupt-driven read finish first
+	i2c_async_wait();
+
     i2c_start_wait(address+I2C_WRITE);
     i2c_write(location);							// Set up register address 
     i2c_rep_start(address+I2C_READ);
@@ -54,4 +102,179 @@ void readI2CbyteArray(uint8_t address, uint8_t location, uint8_t *array,uint8_t
     i2c_stop();
 }
 
+//************************************************************
+// Read accel, temperature and gyro data from the MPU6050 in 
+// one 14-byte burst so that all come from the same instant.
+// With SENSOR_FIFO, read all the samples queued in the FIFO 
+// and average them. If start_sensor_read() has already started
+// the burst in the background, just wait for it to finish.
+//************************************************************
+
+void read_sensors(void)
+{
+	uint8_t i;
+	bool	done = false;
+	int16_t *words = (int16_t *)&SensorSample;
+
+	if (SensorReadPending)
+	{
+		SensorReadPending = false;
+		done = (i2c_async_wait() == 0);
+	}
+
+	// Blocking read if nothing was started or the background read failed
+	if (!done)
+	{
+#ifdef SENSOR_FIFO
+		// Everything queued since the last read, or a single sample if the FIFO is empty
+		FifoSamples = read_fifo_count();
+
+		if (FifoSamples > 0)
+		{
+			readI2CbyteArray(MPU60X0_DEFAULT_ADDRESS,MPU60X0_RA_FIFO_R_W,(uint8_t *)SensorData,FifoSamples * SENSOR_SAMPLE_SIZE);
+		}
+		else
+#endif
+		{
+			readI2CbyteArray(MPU60X0_DEFAULT_ADDRESS,MPU60X0_RA_ACCEL_XOUT_H,(uint8_t *)SensorData,SENSOR_SAMPLE_SIZE);
+		}
+	}
+
+#ifdef SENSOR_FIFO
+	if (FifoSamples > 0)
+	{
+		average_fifo(FifoSamples);
+		FifoSamples = 0;
+		SensorSampleFresh = SAMPLE_GYRO | SAMPLE_ACC;
+		return;
+	}
+#endif
+
+	// Registers are big-endian, in the same order as sensor_sample_t
+	for (i = 0; i < 7; i++)
+	{
+		words[i] = (int16_t)((SensorData[i << 1] << 8) | SensorData[(i << 1) + 1]);
+	}
+
+	SensorSampleFresh = SAMPLE_GYRO | SAMPLE_ACC;
+}
+
+//************************************************************
+// Start the next sensor burst in the background.
+// The data is collected by the next call to read_sensors().
+// With SENSOR_FIFO only the 2-byte FIFO count is read here
+// while waiting. The samples follow in the background.
+//************************************************************
+
+void start_sensor_read(void)
+{
+	if (!SensorReadPending)
+	{
+#ifdef SENSOR_FIFO
+		FifoSamples = read_fifo_count();
+
+		if (FifoSamples > 0)
+		{
+			SensorReadPending = (i2c_read_async(MPU60X0_DEFAULT_ADDRESS,MPU60X0_RA_FIFO_R_W,(uint8_t *)SensorData,FifoSamples * SENSOR_SAMPLE_SIZE) == 0);
+		}
+#else
+		SensorReadPending = (i2c_read_async(MPU60X0_DEFAULT_ADDRESS,MPU60X0_RA_ACCEL_XOUT_H,(uint8_t *)SensorData,SENSOR_SAMPLE_SIZE) == 0);
+#endif
+
+		// Make sure the next read uses this new sample
+		SensorSampleFresh = 0;
+	}
+}
+
+//************************************************************
+// Set the MPU6050 LPF. With SENSOR_FIFO the sample rate 
+// divider is also set for 1kHz and the FIFO restarted.
+//************************************************************
+
+void set_sensor_rate(void)
+{
+	// MPU6050's internal LPF. Values are 0x06 = 5Hz, (5)10Hz, (4)21Hz, (3)44Hz, (2)94Hz, (1)184Hz LPF, (0)260Hz
+	// Software's values are 0 to 6 = 5Hz to 260Hz, so numbering is reversed here.
+	writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_CONFIG, (6 - Config.MPU6050_LPF));
 
+#ifdef SENSOR_FIFO
+	// The gyro rate is 8kHz with the 260Hz LPF and 1kHz otherwise
+	if (Config.MPU6050_LPF >= HZ260)
+	{
+		writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_SMPLRT_DIV, 7);
+	}
+	else
+	{
+		writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_SMPLRT_DIV, 0);
+	}
+
+	writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_FIFO_EN, FIFO_ENABLE_ALL);
+	writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_USER_CTRL, FIFO_RUN);
+#endif
+}
+
+#ifdef SENSOR_FIFO
+//************************************************************
+// Return the number of whole samples in the MPU6050 FIFO.
+// The FIFO holds the same 14 bytes per sample as the registers.
+// Returns 0 if it is empty, or if it had to be restarted 
+// because it was out of step or had backed up.
+//************************************************************
+
+uint8_t read_fifo_count(void)
+{
+	uint8_t count_data[2];
+	uint16_t count;
+	uint8_t samples = 0;
+
+	readI2CbyteArray(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_FIFO_COUNTH, (uint8_t *)count_data, 2);
+	count = (count_data[0] << 8) | count_data[1];
+
+	// Count whole samples
+	while ((count >= SENSOR_SAMPLE_SIZE) && (samples <= FIFO_MAX_SAMPLES))
+	{
+		count -= SENSOR_SAMPLE_SIZE;
+		samples++;
+	}
+
+	// Restart the FIFO if it is out of step or has backed up (after menus etc)
+	if ((count != 0) || (samples > FIFO_MAX_SAMPLES))
+	{
+		writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_USER_CTRL, FIFO_RUN);
+		return 0;
+	}
+
+	return samples;
+}
+
+//************************************************************
+// Average the samples read from the FIFO into SensorSample
+//************************************************************
+
+void average_fifo(uint8_t samples)
+{
+	uint8_t s, w;
+	uint8_t *data = SensorData;
+	uint16_t recip;
+	int32_t sums[SENSOR_SAMPLE_SIZE / 2];
+	int16_t *words = (int16_t *)&SensorSample;
+
+	memset(sums, 0, sizeof(sums));
+
+	for (s = 0; s < samples; s++)
+	{
+		for (w = 0; w < (SENSOR_SAMPLE_SIZE / 2); w++)
+		{
+			sums[w] += (int16_t)((data[0] << 8) | data[1]);
+			data += 2;
+		}
+	}
+
+	recip = pgm_read_word(&FifoReciprocal[samples]);
+
+	for (w = 0; w < (SENSOR_SAMPLE_SIZE / 2); w++)
+	{
+		words[w] = (int16_t)((sums[w] * recip) >> 12);
+	}
+}
+#endif
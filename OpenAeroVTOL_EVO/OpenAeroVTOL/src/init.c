@@ -304,6 +304,9 @@ void init(void)
 	//***********************************************************	
 
 	i2c_init();
+#ifdef BOARD_ALIGNMENT
+	init_board_alignment();
+#endif
 	init_i2c_gyros();
 	init_i2c_accs();
 
@@ -23,6 +23,12 @@
 
 #define CONTRAST 159 // Contrast item number <--- This sucks... move somewhere sensible!!!!!
 
+// Screen areas used for partial updates
+#define ITEM_HEIGHT 11		// Verdana8 line height
+#define CURSOR_HEIGHT 13	// Wingdings cursor height
+#define VALUE_LINE 25		// Top of the Verdana14 value in do_menu_item()
+#define VALUE_HEIGHT 19		// Verdana14 line height
+
 //************************************************************
 // Prototypes
 //************************************************************
@@ -78,9 +84,6 @@ void print_menu_frame(uint8_t style)
 		LCD_Display_Text(9, (const unsigned char*)Wingdings, 80, 59);	// Down
 		LCD_Display_Text(17, (const unsigned char*)Verdana8, 103, 54);	// Save
 	}
-
-	// Write from buffer
-	write_buffer(buffer);
 }
 
 //**********************************************************************
@@ -95,19 +98,60 @@ void print_menu_frame(uint8_t style)
 // MenuOffsets = originally an array, now just a fixed horizontal offset for the value text
 // text_link = pointer to the text list for the values if not numeric
 // cursor = cursor position
+//
+// The whole screen is only redrawn when the list itself changes or 
+// something else has cleared the buffer. Otherwise just the lines
+// whose values changed and the old and new cursor are redrawn, and
+// only the LCD pages they touch are sent.
 //**********************************************************************
 void print_menu_items(uint16_t top, uint16_t start, int8_t values[], const unsigned char* menu_ranges, uint8_t rangetype, uint8_t MenuOffsets, const unsigned char* text_link, uint8_t cursor)
 {
+	static int8_t*	last_values = NULL;
+	static const unsigned char* last_ranges = NULL;
+	static const unsigned char* last_text_link = NULL;
+	static uint16_t	last_top = 0;
+	static uint16_t	last_start = 0;
+	static uint8_t	last_cursor = 0;
+	static int8_t	shown[4];
+
 	menu_range_t	range1;
-		
-	// Clear buffer before each update
-	clear_buffer(buffer);
-	print_menu_frame(0);
+	uint8_t			pages = 0;
+	uint8_t			line;
+	bool			redraw_all;
+
+	// Redraw everything if the buffer no longer holds this list
+	redraw_all = (!menu_buffer_valid) || (values != last_values) || (menu_ranges != last_ranges) ||
+				 (text_link != last_text_link) ||
+				 (top != last_top) || (start != last_start);
+
+	if (redraw_all)
+	{
+		// Clear buffer before each update
+		clear_buffer(buffer);
+		print_menu_frame(0);
+		pages = LCD_ALL_PAGES;
+	}
 	
 	// Print each line
 	for (uint8_t i = 0; i < 4; i++)
 	{
-		LCD_Display_Text(top+i,(const unsigned char*)Verdana8,ITEMOFFSET,(uint8_t)pgm_read_byte(&lines[i]));
+		line = (uint8_t)pgm_read_byte(&lines[i]);
+
+		// Skip lines that are already up to date
+		if (!redraw_all)
+		{
+			if (values[top+i - start] == shown[i])
+			{
+				continue;
+			}
+
+			fillrect(buffer, ITEMOFFSET, line, (LCDWIDTH - ITEMOFFSET), ITEM_HEIGHT, 0);
+			pages |= lcd_page_mask(line, ITEM_HEIGHT);
+		}
+
+		shown[i] = values[top+i - start];
+
+		LCD_Display_Text(top+i,(const unsigned char*)Verdana8,ITEMOFFSET,line);
 
 		// Handle unique or copied ranges (to reduce space)
 		if (rangetype == 0)
@@ -121,11 +165,30 @@ void print_menu_items(uint16_t top, uint16_t start, int8_t values[], const unsig
 			memcpy_P(&range1, &menu_ranges[0], sizeof(range1));
 		}
 
-		print_menu_text((values[top+i - start]), range1.style, (pgm_read_byte(&text_link[top+i - start]) + values[top+i - start]), MenuOffsets, (uint8_t)pgm_read_byte(&lines[i]));
+		print_menu_text((values[top+i - start]), range1.style, (pgm_read_byte(&text_link[top+i - start]) + values[top+i - start]), MenuOffsets, line);
 	}
 
-	print_cursor(cursor);	// Cursor
-	write_buffer(buffer);
+	// Move the cursor if required
+	if (redraw_all || (cursor != last_cursor))
+	{
+		if (!redraw_all)
+		{
+			fillrect(buffer, 0, last_cursor, ITEMOFFSET, CURSOR_HEIGHT, 0);
+			pages |= lcd_page_mask(last_cursor, CURSOR_HEIGHT) | lcd_page_mask(cursor, CURSOR_HEIGHT);
+		}
+
+		print_cursor(cursor);	// Cursor
+	}
+
+	menu_buffer_valid = true;
+	last_values = values;
+	last_ranges = menu_ranges;
+	last_text_link = text_link;
+	last_top = top;
+	last_start = start;
+	last_cursor = cursor;
+
+	write_buffer_pages(buffer, pages);
 	poll_buttons(true);
 }
 
@@ -157,6 +220,7 @@ void do_menu_item(uint16_t menuitem, int8_t *values, uint8_t mult, menu_range_t
 	mugui_size16_t size;
 	int16_t temp16;
 	int16_t value = (int8_t)*values;
+	int16_t shown_value = 0;
 	uint8_t display_update = 0;
 	uint8_t servo_update = 0;
 	uint8_t button_update = 0;
@@ -212,24 +276,35 @@ void do_menu_item(uint16_t menuitem, int8_t *values, uint8_t mult, menu_range_t
 		}
 
 		// Display update
-		if 	(!servo_enable || 									// Non-servo value or
-			((display_update >= 8) && (button != NONE)) || 		// Servo value and 8 cycles passed but only with a button pressed or...
-			 (first_time))										// First time into routine
+		// The title and frame are only drawn the first time. After that just the value lines are
+		// cleared and rewritten, and only when the value has changed.
+		if 	((first_time) ||															// First time into routine or
+			((value != shown_value) && (!servo_enable || (display_update >= 8))))		// Value changed, but only every 8 cycles for servos
 		{
 			display_update = 0;
-			first_time = false;
+			shown_value = value;
 
-			clear_buffer(buffer);
+			if (first_time)
+			{
+				clear_buffer(buffer);
 
-			// Print title
-			gLCDprint_Menu_P((char*)pgm_read_word(&text_menu[menuitem]), (const unsigned char*)Verdana14, 0, 0);
+				// Print title
+				gLCDprint_Menu_P((char*)pgm_read_word(&text_menu[menuitem]), (const unsigned char*)Verdana14, 0, 0);
+
+				// Print bottom markers
+				print_menu_frame(1);
+			}
+			else
+			{
+				clear_buffer_pages(buffer, lcd_page_mask(VALUE_LINE, VALUE_HEIGHT));
+			}
 
 			// Print value
 			if ((range.style == 0) || (range.style == 2) || (range.style == 3)) // numeric, numeric * 4, servo limits
 			{
 				// Write numeric value, centered on screen
 				mugui_text_sizestring(itoa(value,pBuffer,10), (const unsigned char*)Verdana14, &size);
-				mugui_lcd_puts(itoa(value,pBuffer,10),(const unsigned char*)Verdana14,((128-size.x)/2)+offset,25);
+				mugui_lcd_puts(itoa(value,pBuffer,10),(const unsigned char*)Verdana14,((128-size.x)/2)+offset,VALUE_LINE);
 			}
 			else // text
 			{
@@ -238,14 +313,19 @@ void do_menu_item(uint16_t menuitem, int8_t *values, uint8_t mult, menu_range_t
 				pgm_mugui_scopy((char*)pgm_read_word(&text_menu[text_link + value])); // Copy string to pBuffer
 
 				mugui_text_sizestring((char*)pBuffer, (const unsigned char*)Verdana14, &size);
-				LCD_Display_Text(text_link + value, (const unsigned char*)Verdana14,((128-size.x)/2),25);
+				LCD_Display_Text(text_link + value, (const unsigned char*)Verdana14,((128-size.x)/2),VALUE_LINE);
 			}
 
-			// Print bottom markers
-			print_menu_frame(1);
-
 			// Write from buffer
-			write_buffer(buffer);
+			if (first_time)
+			{
+				first_time = false;
+				write_buffer(buffer);
+			}
+			else
+			{
+				write_buffer_pages(buffer, lcd_page_mask(VALUE_LINE, VALUE_HEIGHT));
+			}
 		}
 		
 		// Slow the loop rate for text items
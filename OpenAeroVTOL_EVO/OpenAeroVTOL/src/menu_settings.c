@@ -147,7 +147,7 @@ void menu_rc_setup(uint8_t section)
 			UpdateLimits();			// Update I-term limits and triggers based on percentages
 
 			// Update MPU6050 LPF and reverse sense of menu items
-			writeI2Cbyte(MPU60X0_DEFAULT_ADDRESS, MPU60X0_RA_CONFIG, (6 - Config.MPU6050_LPF));
+			set_sensor_rate();
 
 			// Update channel sequence
 			for (i = 0; i < MAX_RC_CHANNELS; i++)
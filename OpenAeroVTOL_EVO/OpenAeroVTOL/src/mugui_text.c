@@ -68,6 +68,10 @@ void mugui_lcd_puts(mugui_char_t *s, const unsigned char* font,mugui_uint16_t x,
 mugui_uint16_t mugui_lcd_putc(mugui_char_t c, const unsigned char* font,mugui_uint16_t x, mugui_uint16_t y);
 void pgm_mugui_lcd_puts(const unsigned char* s, const unsigned char* font,mugui_uint16_t x, mugui_uint16_t y);
 void pgm_mugui_scopy(const char *s);
+mugui_uint8_t reverse_byte(mugui_uint8_t b);
+
+// Bit-reversed nibbles for converting font bytes to LCD page bit order
+const mugui_uint8_t reverse_nibble[16] PROGMEM = {0x0,0x8,0x4,0xC,0x2,0xA,0x6,0xE,0x1,0x9,0x5,0xD,0x3,0xB,0x7,0xF};
 
 /*************************************************************************/
 /*! \brief  calculate the size of a string 
@@ -176,6 +180,17 @@ void mugui_lcd_puts(mugui_char_t *s, const unsigned char* font,mugui_uint16_t x,
 	}
 }
 
+/*************************************************************************/
+/*! \brief  reverse the bit order of a byte
+	\param  byte b
+	\return b with bit 0 swapped with bit 7, bit 1 with bit 6 etc.
+*/
+/************************************************************************/
+mugui_uint8_t reverse_byte(mugui_uint8_t b)
+{
+	return (pgm_read_byte(&reverse_nibble[b & 0x0f]) << 4) | pgm_read_byte(&reverse_nibble[b >> 4]);
+}
+
 /*************************************************************************/
 /*! \brief  display character for monospace and proportional fonts 
 	\param  character c
@@ -185,6 +200,8 @@ void mugui_lcd_puts(mugui_char_t *s, const unsigned char* font,mugui_uint16_t x,
 	\return character width
 	\date 	13.11.2009
 	\Modified by D. Thompson 14/08/2012 - Now hard-coded for proportional, type 2 (verticalCeiling)
+	\Glyph bytes are now written a byte at a time into the LCD pages.
+	\Rows that are not a multiple of 8 are shifted across two pages.
 */
 /************************************************************************/
 mugui_uint16_t mugui_lcd_putc(mugui_char_t c, const unsigned char* font,mugui_uint16_t x, mugui_uint16_t y)
@@ -197,13 +214,14 @@ mugui_uint16_t mugui_lcd_putc(mugui_char_t c, const unsigned char* font,mugui_ui
 	mugui_uint8_t  indexhighbyte = 0; 		//high byte of the bitmap address in the array
 	mugui_uint32_t indexaddress = 0;		//bitmap address in the array (derived from low and high byte)
 	mugui_uint16_t tx = 0;	 				//temporary x
-	mugui_uint16_t ty = 0;	 				//temporary y
 	mugui_uint8_t  tb= 0;     				//temporary byte
 	mugui_uint8_t  data= 0;					//databyte
-	mugui_uint8_t  mask= 0;					//bitmask
-	mugui_uint8_t  bit= 0;					//bit value
-	mugui_uint8_t  tc= 0;	 				//temorary count
+	mugui_uint8_t  mask= 0;					//bitmask of rows in use
+	mugui_uint8_t  rows= 0;					//rows left to draw
+	mugui_uint8_t  shift= 0;				//row offset within the LCD page
+	mugui_uint8_t  page= 0;					//LCD page being written
 	mugui_uint8_t  bytes= 0;  				//bytes per line or row
+	mugui_uint8_t* column;					//buffer location of the current column
 
 	/* Read header of the font          */
 	/* pgm_read_byte is ATMega specific */
@@ -221,31 +239,63 @@ mugui_uint16_t mugui_lcd_putc(mugui_char_t c, const unsigned char* font,mugui_ui
 
 	/* Determine the number of bytes for given width */ 
 	bytes = ((height-1)>>3)+1;
+	shift = y & 7;
+
 	/* For every column */
-	for(tx= 0; tx < width; tx++) //for every row
+	for(tx= 0; tx < width; tx++)
 	{
-		ty = 0;
+		/* Clip at the right-hand edge */
+		if ((tx + x) >= LCDWIDTH)
+		{
+			break;
+		}
+
+		rows = height;
+		page = y >> 3;
+		column = &buffer[(tx + x) + (page * LCDWIDTH)];
+
 		/* For every byte */
-		for(tb = 0; tb < bytes; tb ++)
+		for(tb = 0; tb < bytes; tb++)
 		{
 			/* Read bytes from program memory - ATMega specific */
-			data = pgm_read_byte(&font[indexaddress + 1 + bytes*tx + tb]);
-			/* For every bit within the height */
-			for(tc = 0;  ( (tc < 8) && (ty < height) ); tc ++)
+			/* Font data has the top row in bit 0, the buffer has it in bit 7 */
+			data = reverse_byte(pgm_read_byte(&font[indexaddress + 1 + bytes*tx + tb]));
+
+			/* Mask off the rows below the bottom of the glyph */
+			if (rows < 8)
+			{
+				mask = (mugui_uint8_t)(0xff << (8 - rows));
+				rows = 0;
+			}
+			else
+			{
+				mask = 0xff;
+				rows -= 8;
+			}
+
+			/* Byte-aligned rows copy straight into the page */
+			if (shift == 0)
 			{
-					/* Determine the bit mask */
-					mask = 1<<(tc);
-					bit = data & mask;
-					if(bit)
-					{
-						setpixel(buffer,tx+x,ty+y,1);
-					}
-					else
-					{
-						setpixel(buffer,tx+x,ty+y,0);
-					}
-					ty++;
+				if (page < (LCDHEIGHT >> 3))
+				{
+					*column = (*column & ~mask) | (data & mask);
+				}
 			}
+			/* Otherwise split the byte across this page and the next */
+			else
+			{
+				if (page < (LCDHEIGHT >> 3))
+				{
+					*column = (*column & ~(mask >> shift)) | ((data & mask) >> shift);
+				}
+				if ((page + 1) < (LCDHEIGHT >> 3))
+				{
+					column[LCDWIDTH] = (column[LCDWIDTH] & ~(mugui_uint8_t)(mask << (8 - shift))) | (mugui_uint8_t)((data & mask) << (8 - shift));
+				}
+			}
+
+			page++;
+			column += LCDWIDTH;
 		}
 	}
 
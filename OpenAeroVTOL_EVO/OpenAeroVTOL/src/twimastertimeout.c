@@ -13,6 +13,7 @@
 **************************************************************************/
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include "io_cfg.h"
 #include "i2cmaster.h"
 #include "compiledefs.h"
@@ -30,6 +31,17 @@
 /* I2C timer max delay */
 #define I2C_TIMER_DELAY 0xFF
 
+/* Max delay waiting for a whole interrupt-driven transfer */
+#define I2C_ASYNC_TIMEOUT 0x2000
+
+/* Interrupt-driven transfer state */
+volatile uint8_t i2c_async_state = I2C_ASYNC_IDLE;
+static uint8_t i2c_async_address;
+static uint8_t i2c_async_location;
+static uint8_t *i2c_async_buffer;
+static uint8_t i2c_async_size;
+static volatile uint8_t i2c_async_index;
+
 /*************************************************************************
  Initialization of the I2C bus interface. Need to be called only once
 *************************************************************************/
@@ -237,3 +249,121 @@ unsigned char i2c_readNak(void)
 
 }/* i2c_readNak */
 
+
+/*************************************************************************
+ Start an interrupt-driven register read. Returns at once, the transfer 
+ is done by the TWI interrupt.
+
+ Input:   device address, register address, buffer and number of bytes
+ Return:  0 transfer started
+          1 transfer already in progress
+*************************************************************************/
+unsigned char i2c_read_async(unsigned char address, unsigned char location, uint8_t *buffer, uint8_t size)
+{
+	if ((i2c_async_state == I2C_ASYNC_BUSY) || (size == 0))
+		return 1;
+
+	i2c_async_address = address;
+	i2c_async_location = location;
+	i2c_async_buffer = buffer;
+	i2c_async_size = size;
+	i2c_async_index = 0;
+	i2c_async_state = I2C_ASYNC_BUSY;
+
+	// send START condition, the rest is done in the ISR
+	TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+
+	return 0;
+
+}/* i2c_read_async */
+
+
+/*************************************************************************
+ Wait for an interrupt-driven transfer to finish. If it does not finish 
+ in time it is aborted and the bus released as per the blocking calls.
+
+ Return:  0 no transfer pending or transfer completed
+          1 transfer failed or timed out
+*************************************************************************/
+unsigned char i2c_async_wait(void)
+{
+	uint16_t  i2c_timer = I2C_ASYNC_TIMEOUT;
+
+	while((i2c_async_state == I2C_ASYNC_BUSY) && i2c_timer--);
+
+	if (i2c_async_state == I2C_ASYNC_BUSY)
+	{
+		// send stop condition and disable the TWI interrupt
+		TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+		i2c_async_state = I2C_ASYNC_ERROR;
+
+		// wait until stop condition is executed and bus released
+		i2c_timer = I2C_TIMER_DELAY;
+		while((TWCR & (1<<TWSTO)) && i2c_timer--);
+	}
+
+	return (i2c_async_state == I2C_ASYNC_ERROR);
+
+}/* i2c_async_wait */
+
+
+/*************************************************************************
+ TWI interrupt - steps through the register read started by 
+ i2c_read_async(). Any unexpected status ends the transfer with an error.
+*************************************************************************/
+ISR(TWI_vect)
+{
+	switch(TW_STATUS & 0xF8)
+	{
+		case TW_START:
+			TWDR = i2c_async_address + I2C_WRITE;
+			TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+			break;
+
+		case TW_MT_SLA_ACK:
+			TWDR = i2c_async_location;
+			TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+			break;
+
+		case TW_MT_DATA_ACK:
+			// Register address sent, send repeated start
+			TWCR = (1<<TWINT) | (1<<TWSTA) | (1<<TWEN) | (1<<TWIE);
+			break;
+
+		case TW_REP_START:
+			TWDR = i2c_async_address + I2C_READ;
+			TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+			break;
+
+		case TW_MR_DATA_ACK:
+			i2c_async_buffer[i2c_async_index++] = TWDR;
+			// Fall through to request the next byte
+
+		case TW_MR_SLA_ACK:
+			// ACK all but the last byte
+			if ((i2c_async_index + 1) < i2c_async_size)
+			{
+				TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE) | (1<<TWEA);
+			}
+			else
+			{
+				TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE);
+			}
+			break;
+
+		case TW_MR_DATA_NACK:
+			// Last byte, release the bus
+			i2c_async_buffer[i2c_async_index++] = TWDR;
+			TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+			i2c_async_state = I2C_ASYNC_IDLE;
+			break;
+
+		default:
+			// NACK, arbitration lost or bus error
+			TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+			i2c_async_state = I2C_ASYNC_ERROR;
+			break;
+	}
+
+}/* TWI_vect */
+
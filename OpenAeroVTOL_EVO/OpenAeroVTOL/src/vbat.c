@@ -29,18 +29,19 @@ uint16_t GetVbat(void)				// Get battery voltage (VBAT on ADC3)
 {
 	uint16_t	vBat;				// Battery voltage
 		
-	read_adc(AIN_VBAT1);				// Multiplication factor = (Display volts / 1024) / (Vbat / 11 / Vref)
+	// Filtered ADC value, 16 times oversampled. No waiting required.
+	vBat = get_adc_filtered(ADC_SLOT_VBAT);
+
+	// Multiplication factor = (Display volts / 1024) / (Vbat / 11 / Vref)
 
 	// For Vref = 2.45V, Multiplication factor = 2.632
 	// For Vref = 2.305V, Multiplication factor = approx 2.5
 	// An input voltage of 10V will results in a value of 999.
 	// This means that the number represents units of 10mV.
 
-	vBat = ADCW;
-
-	// Multiply by 2.578125
-	// 2 + 1/2 + 1/16 + 1/64
-	vBat = (vBat << 1) + (vBat >> 1) + (vBat >> 4) + (vBat >> 6); // Multiply by 2.578125
+	// Multiply by 2.578125 / 16 = 0.1611328125
+	// 1/8 + 1/32 + 1/256 + 1/1024
+	vBat = (vBat >> 3) + (vBat >> 5) + (vBat >> 8) + (vBat >> 10); // Multiply by 2.578125 / 16
 
 	return vBat;
 }
@@ -0,0 +1,28 @@
+/*********************************************************************
+ * avr/eeprom.h - host build stand-in
+ ********************************************************************/
+
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+uint8_t host_eeprom[1024] __attribute__((weak));
+
+static inline uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	return host_eeprom[(uintptr_t)addr & 1023];
+}
+
+static inline void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+	host_eeprom[(uintptr_t)addr & 1023] = value;
+}
+
+static inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+	memcpy(dst, &host_eeprom[(uintptr_t)src & 1023], n);
+}
+
+#endif
@@ -0,0 +1,12 @@
+/*********************************************************************
+ * avr/interrupt.h - host build stand-in
+ ********************************************************************/
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#define sei()
+#define cli()
+#define ISR(vector) void vector(void)
+
+#endif
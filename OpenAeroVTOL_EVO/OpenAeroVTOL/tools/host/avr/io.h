@@ -0,0 +1,31 @@
+/*********************************************************************
+ * avr/io.h - host build stand-in
+ *
+ * Lets the display code in src/ compile on a PC for the programs in
+ * tools/. Each I/O register is a plain variable shared by all files,
+ * so a host program can drive PINB or watch the LCD pins on PORTD.
+ * They are 32 bits wide as REGISTER_BIT() in typedefs.h casts them
+ * to an unsigned int bitfield.
+ ********************************************************************/
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define HOST_REG(name) volatile uint32_t name __attribute__((weak))
+
+HOST_REG(PORTA); HOST_REG(PORTB); HOST_REG(PORTC); HOST_REG(PORTD);
+HOST_REG(PINA);  HOST_REG(PINB);  HOST_REG(PINC);  HOST_REG(PIND);
+HOST_REG(DDRA);  HOST_REG(DDRB);  HOST_REG(DDRC);  HOST_REG(DDRD);
+HOST_REG(TCCR0A); HOST_REG(TCCR0B); HOST_REG(TCNT0); HOST_REG(TIMSK0); HOST_REG(TIFR0);
+HOST_REG(TCCR1A); HOST_REG(TCCR1B); HOST_REG(TCNT1); HOST_REG(OCR1B); HOST_REG(TIFR1);
+HOST_REG(TCCR2A); HOST_REG(TCCR2B); HOST_REG(TCNT2); HOST_REG(TIMSK2); HOST_REG(TIFR2);
+HOST_REG(ADC); HOST_REG(ADCSRA); HOST_REG(ADCSRB); HOST_REG(ADMUX); HOST_REG(DIDR0);
+HOST_REG(EICRA); HOST_REG(EIMSK); HOST_REG(EIFR);
+HOST_REG(PCICR); HOST_REG(PCIFR); HOST_REG(PCMSK1); HOST_REG(PCMSK3);
+HOST_REG(TWBR); HOST_REG(TWCR); HOST_REG(TWDR); HOST_REG(TWSR);
+HOST_REG(UBRR0H); HOST_REG(UBRR0L); HOST_REG(UCSR0A); HOST_REG(UCSR0B); HOST_REG(UCSR0C); HOST_REG(UDR0);
+HOST_REG(MCUSR); HOST_REG(SREG);
+
+#endif
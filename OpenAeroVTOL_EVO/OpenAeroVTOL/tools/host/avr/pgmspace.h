@@ -0,0 +1,19 @@
+/*********************************************************************
+ * avr/pgmspace.h - host build stand-in
+ ********************************************************************/
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+// Reads the pointed-to type, so tables of pointers still work with host-sized pointers
+#define pgm_read_word(addr) (*(addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+
+#endif
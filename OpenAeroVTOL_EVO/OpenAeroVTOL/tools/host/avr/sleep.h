@@ -0,0 +1,10 @@
+/*********************************************************************
+ * avr/sleep.h - host build stand-in
+ ********************************************************************/
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#define sleep_mode()
+
+#endif
@@ -0,0 +1,20 @@
+/*********************************************************************
+ * stdlib.h - host build stand-in
+ *
+ * Adds itoa(), which avr-libc has and the host C library does not.
+ ********************************************************************/
+
+#ifndef HOST_STDLIB_H
+#define HOST_STDLIB_H
+
+#include_next <stdlib.h>
+#include <stdio.h>
+
+char * __attribute__((weak)) itoa(int value, char *s, int radix)
+{
+	(void)radix;
+	sprintf(s, "%d", value);
+	return s;
+}
+
+#endif
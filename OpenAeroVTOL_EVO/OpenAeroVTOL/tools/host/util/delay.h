@@ -0,0 +1,15 @@
+/*********************************************************************
+ * util/delay.h - host build stand-in
+ ********************************************************************/
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+// A host program may define host_delay_ms() to follow time or to act
+// while the firmware waits. By default delays return at once.
+void __attribute__((weak)) host_delay_ms(double ms) { (void)ms; }
+
+#define _delay_ms(ms) host_delay_ms(ms)
+#define _delay_us(us) host_delay_ms((us) / 1000.0)
+
+#endif
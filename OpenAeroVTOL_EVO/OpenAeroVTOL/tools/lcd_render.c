@@ -0,0 +1,339 @@
+/*
+ * LCD screen renderer for the display code in src/
+ *
+ * Build on the host:  cc -O2 -fno-strict-aliasing -Ihost -I../inc -o lcd_render lcd_render.c
+ *                        ../src/glcd_driver.c ../src/mugui_text.c ../src/glcd_menu.c ../src/menu_*.c
+ *                        ../src/display_*.c ../src/eeprom.c
+ * Usage:              lcd_render [output directory]
+ *
+ * Runs the idle screen, the status screen and a tour of the menus, and writes
+ * each screen as a PBM image along with the bytes sent to the LCD to draw it.
+ * The ST7565 is emulated from the bit-banged SPI lines, so the images show what
+ * the panel would show, partial page updates included.
+ *
+ * The menus are driven by a list of button presses. A screen is captured when
+ * the firmware next waits with no button held, after the LCD has been written
+ * or a second has passed. The byte counts on each line are everything sent
+ * since the previous capture, i.e. the cost of drawing that screen. The idle
+ * and status screens are sent LCD_FLUSH_BYTES per call, as the main loop does,
+ * and "pass" is the most sent in one call; the menus send a screen in one go.
+ * The times convert bytes at SPI_US_PER_BYTE, which is how long the servo
+ * outputs wait on the bit-banged SPI.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <setjmp.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "io_cfg.h"
+#include "main.h"
+#include "glcd_driver.h"
+#include "menu_ext.h"
+#include "eeprom.h"
+#include "Font_Verdana.h"
+#include "Font_WingdingsOE2.h"
+
+#define HOLD_MS 20				// How long each button is held down
+#define IDLE_TIMEOUT_MS 1000	// Capture after this long even if nothing was drawn
+#define BUTTONS_UP (NONE | 0x0f)
+
+// spiwrite() counted from its source: about 40 cycles a bit at 20MHz, most of them in
+// the shift loop -Os makes of (1 << i). An estimate, override it with a timed figure.
+#ifndef SPI_US_PER_BYTE
+#define SPI_US_PER_BYTE 16
+#endif
+
+typedef struct
+{
+	uint8_t button;
+	const char *name;
+} press_t;
+
+//***********************************************************
+//* Firmware globals and the functions the screens call
+//***********************************************************
+
+uint8_t buffer[1024];
+char pBuffer[PBUFFER_SIZE];
+CONFIG_STRUCT Config;
+volatile uint8_t General_error;
+volatile uint16_t InterruptCount;
+volatile int16_t RCinputs[MAX_RC_CHANNELS + 1] = {0, 120, -340, 75, 500, -500, 0, 250, 0};
+volatile int16_t MonopolarThrottle = 1125;
+int16_t accADC[NUMBEROFAXIS] = {-12, 31, 1980};
+float accSmooth[NUMBEROFAXIS] = {-12.0, 31.0, 1980.0};
+int16_t gyroADC[NUMBEROFAXIS] = {3, -5, 1};
+int16_t transition = 0;
+
+static void host_wait(double ms);
+
+void RxGetChannels(void) { host_wait(0); }
+void ReadGyros(void) { host_wait(0); }
+void ReadAcc(void) { host_wait(0); }
+void imu_update(uint32_t period) { (void)period; }
+void CenterSticks(void) {}
+void CalibrateAcc(int8_t type) { (void)type; }
+void CalibrateGyrosFast(void) {}
+void UpdateLimits(void) {}
+void init_int(void) {}
+void init_uart(void) {}
+void set_sensor_rate(void) {}
+uint16_t GetVbat(void) { return 1180; }
+int16_t scale_percent(int8_t value) { return 3750 + (value * 10); }
+void output_servo_ppm_asm3(int16_t servo_number, int16_t value) { (void)servo_number; (void)value; }
+
+void host_delay_ms(double ms) { host_wait(ms); }
+
+//***********************************************************
+//* ST7565 emulation
+//***********************************************************
+
+static uint8_t lcd_ram[8][132];
+static uint8_t lcd_page;
+static uint8_t lcd_column;
+static uint8_t lcd_param;		// Set when the next command byte is a parameter
+static uint8_t spi_byte;
+static uint8_t spi_bits;
+static uint16_t lcd_data_bytes;		// Bytes seen on the SPI lines with A0 high
+static uint16_t lcd_command_bytes;	// and with A0 low
+
+static void lcd_command(uint8_t c)
+{
+	if (lcd_param)
+	{
+		lcd_param = 0;
+		return;
+	}
+
+	switch (c & 0xf0)
+	{
+		case CMD_SET_PAGE:
+			lcd_page = c & 0x07;
+			break;
+		case CMD_SET_COLUMN_UPPER:
+			lcd_column = (lcd_column & 0x0f) | ((c & 0x0f) << 4);
+			break;
+		case CMD_SET_COLUMN_LOWER:
+			lcd_column = (lcd_column & 0xf0) | (c & 0x0f);
+			break;
+		default:
+			// Two-byte commands
+			if ((c == CMD_SET_VOLUME_FIRST) || (c == CMD_SET_STATIC_OFF) ||
+				(c == CMD_SET_STATIC_ON) || (c == CMD_SET_BOOSTER_FIRST))
+			{
+				lcd_param = 1;
+			}
+			break;
+	}
+}
+
+// spiwrite() calls this once per bit, just after the rising clock edge
+void glcd_delay(void)
+{
+	spi_byte = (spi_byte << 1) | (LCD_SI ? 1 : 0);
+
+	if (++spi_bits < 8)
+	{
+		return;
+	}
+
+	spi_bits = 0;
+
+	if (LCD_A0)
+	{
+		lcd_data_bytes++;
+
+		if (lcd_column < sizeof(lcd_ram[0]))
+		{
+			lcd_ram[lcd_page][lcd_column++] = spi_byte;
+		}
+	}
+	else
+	{
+		lcd_command_bytes++;
+		lcd_command(spi_byte);
+	}
+}
+
+//***********************************************************
+//* Screen capture and button script
+//***********************************************************
+
+static const char *outdir = ".";
+static const char *session;
+static const char *last_press;
+static const press_t *script;
+static jmp_buf session_end;
+static int frame;
+static uint8_t held = NONE;
+static double held_ms;
+static double idle_ms;
+static uint16_t data_at_press;
+static uint16_t data_at_capture;
+static uint16_t commands_at_capture;
+static uint16_t pass_bytes;			// Most bytes sent in one main loop pass, 0 if sent in one go
+
+// Write the panel as a binary PBM. Buffer page p is sent to LCD page 7 - p, top row in bit 7.
+static void write_pbm(const char *name)
+{
+	char path[512];
+	uint8_t row[LCDWIDTH / 8];
+	FILE *out;
+	int x, y;
+
+	snprintf(path, sizeof(path), "%s/%s.pbm", outdir, name);
+	out = fopen(path, "wb");
+	if (out == NULL)
+	{
+		perror(path);
+		exit(1);
+	}
+
+	fprintf(out, "P4\n%d %d\n", LCDWIDTH, LCDHEIGHT);
+	for (y = 0; y < LCDHEIGHT; y++)
+	{
+		memset(row, 0, sizeof(row));
+		for (x = 0; x < LCDWIDTH; x++)
+		{
+			if (lcd_ram[7 - (y >> 3)][x] & (0x80 >> (y & 7)))
+			{
+				row[x >> 3] |= 0x80 >> (x & 7);
+			}
+		}
+		fwrite(row, 1, sizeof(row), out);
+	}
+
+	fclose(out);
+}
+
+static void capture(void)
+{
+	char name[64];
+
+	snprintf(name, sizeof(name), "%s_%02d", session, frame++);
+	write_pbm(name);
+
+	uint16_t data = lcd_data_bytes - data_at_capture;
+	uint16_t commands = lcd_command_bytes - commands_at_capture;
+	uint16_t pass = pass_bytes ? pass_bytes : (data + commands);
+
+	printf("%-10s %-6s %6u %6u %6u %8.2f %8.2f\n", name, last_press, data, commands, pass,
+		   (data + commands) * SPI_US_PER_BYTE / 1000.0, pass * SPI_US_PER_BYTE / 1000.0);
+
+	data_at_capture = lcd_data_bytes;
+	commands_at_capture = lcd_command_bytes;
+	pass_bytes = 0;
+}
+
+// Called whenever the firmware waits or reads a sensor. Releases the button once
+// it has been held for HOLD_MS. When no button is held and the screen has been
+// updated since the last press, captures it and presses the next button.
+static void host_wait(double ms)
+{
+	if (held != NONE)
+	{
+		held_ms += ms;
+		if (held_ms >= HOLD_MS)
+		{
+			held = NONE;
+			PINB = BUTTONS_UP;
+		}
+		return;
+	}
+
+	idle_ms += ms;
+	if ((lcd_data_bytes == data_at_press) && (idle_ms < IDLE_TIMEOUT_MS))
+	{
+		return;
+	}
+
+	capture();
+
+	if (script == NULL || script->name == NULL)
+	{
+		longjmp(session_end, 1);
+	}
+
+	held = script->button;
+	last_press = script->name;
+	script++;
+
+	PINB = held | 0x0f;
+	held_ms = 0;
+	idle_ms = 0;
+	data_at_press = lcd_data_bytes;
+}
+
+static void run_session(const char *name, void (*screen)(void), const press_t *presses)
+{
+	session = name;
+	script = presses;
+	last_press = "-";
+	frame = 0;
+	held = NONE;
+	idle_ms = 0;
+	PINB = BUTTONS_UP;
+	data_at_press = lcd_data_bytes;
+
+	if (setjmp(session_end) == 0)
+	{
+		screen();
+
+		// Send anything left queued a main loop pass at a time. The first
+		// pass also carries whatever the screen sent while drawing.
+		uint16_t sent = lcd_data_bytes + lcd_command_bytes - data_at_capture - commands_at_capture;
+		bool done;
+
+		do
+		{
+			uint16_t before = lcd_data_bytes + lcd_command_bytes;
+
+			done = flush_buffer_tick(LCD_FLUSH_BYTES);
+			sent += (uint16_t)(lcd_data_bytes + lcd_command_bytes - before);
+			if (sent > pass_bytes)
+			{
+				pass_bytes = sent;
+			}
+			sent = 0;
+		} while (!done);
+
+		capture();
+	}
+}
+
+// Main menu, then General, RX inputs, Sensor calibration, Level meter and Flight profile 1
+static const press_t menu_tour[] =
+{
+	{ ENTER, "ENTER" }, { DOWN, "DOWN" }, { ENTER, "ENTER" }, { UP, "UP" }, { ENTER, "ENTER" }, { BACK, "BACK" },
+	{ DOWN, "DOWN" }, { DOWN, "DOWN" }, { ENTER, "ENTER" }, { BACK, "BACK" },
+	{ DOWN, "DOWN" }, { DOWN, "DOWN" }, { ENTER, "ENTER" }, { BACK, "BACK" },
+	{ DOWN, "DOWN" }, { ENTER, "ENTER" }, { BACK, "BACK" },
+	{ DOWN, "DOWN" }, { ENTER, "ENTER" }, { DOWN, "DOWN" }, { DOWN, "DOWN" }, { DOWN, "DOWN" }, { DOWN, "DOWN" },
+	{ BACK, "BACK" }, { BACK, "BACK" },
+	{ 0, NULL }
+};
+
+int main(int argc, char **argv)
+{
+	if (argc > 1)
+	{
+		outdir = argv[1];
+	}
+
+	Set_EEPROM_Default_Config();
+	PINB = BUTTONS_UP;
+	st7565_init();
+
+	printf("%-10s %-6s %6s %6s %6s %8s %8s\n", "screen", "button", "data", "cmds", "pass", "ms", "pass ms");
+
+	data_at_capture = lcd_data_bytes;
+	commands_at_capture = lcd_command_bytes;
+
+	run_session("idle", idle_screen, NULL);
+	run_session("status", Display_status, NULL);
+	run_session("menu", menu_main, menu_tour);
+
+	return 0;
+}
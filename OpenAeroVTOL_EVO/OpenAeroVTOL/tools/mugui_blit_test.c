@@ -0,0 +1,159 @@
+/*
+ * Glyph blit check for src/mugui_text.c
+ *
+ * Build on the host:  cc -O2 -fno-strict-aliasing -Ihost -I../inc -o mugui_blit_test mugui_blit_test.c ../src/mugui_text.c ../src/glcd_driver.c
+ * Usage:              mugui_blit_test [repeats]
+ *
+ * Draws every glyph of every font at every x and y position, over random
+ * buffer contents, with mugui_lcd_putc() and with the old routine that set
+ * one pixel at a time. The two buffers and the returned widths must match.
+ * It then times both routines drawing the whole character set, byte-aligned
+ * (y = 8) and not (y = 3). Host timings are only a guide to the AVR ratio.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <avr/pgmspace.h>
+#include "io_cfg.h"
+#include "main.h"
+#include "glcd_driver.h"
+#include "Font_Verdana.h"
+#include "Font_WingdingsOE2.h"
+
+uint16_t mugui_lcd_putc(char c, const unsigned char* font, uint16_t x, uint16_t y);
+
+// Globals normally provided by FC_main.c
+uint8_t buffer[1024];
+char pBuffer[PBUFFER_SIZE];
+CONFIG_STRUCT Config;
+
+// glcd_driver.c calls into misc_asm.S
+void glcd_delay(void) {}
+
+static const struct
+{
+	const char *name;
+	const unsigned char *font;
+} fonts[] = {
+	{ "Verdana8", Verdana8 },
+	{ "Verdana14", Verdana14 },
+	{ "Wingdings", Wingdings },
+};
+
+// mugui_lcd_putc() as it was before glyphs were written a byte at a time
+static uint16_t reference_putc(char c, const unsigned char* font, uint16_t x, uint16_t y)
+{
+	uint16_t startcharacter = font[2];
+	uint16_t height = font[4];
+	uint8_t index = c - startcharacter;
+	uint32_t indexaddress = ((uint32_t)font[index*2 + 5] << 8) + font[index*2 + 6];
+	uint16_t width = font[indexaddress];
+	uint8_t bytes = ((height-1)>>3)+1;
+	uint16_t tx, ty;
+	uint8_t tb, tc, data;
+
+	for(tx = 0; tx < width; tx++)
+	{
+		ty = 0;
+		for(tb = 0; tb < bytes; tb++)
+		{
+			data = font[indexaddress + 1 + bytes*tx + tb];
+			for(tc = 0; (tc < 8) && (ty < height); tc++)
+			{
+				setpixel(buffer, tx+x, ty+y, (data & (1<<tc)) ? 1 : 0);
+				ty++;
+			}
+		}
+	}
+
+	return width;
+}
+
+static void fill_random(uint8_t *buff)
+{
+	int i;
+
+	for (i = 0; i < 1024; i++)
+	{
+		buff[i] = rand();
+	}
+}
+
+static double time_charset(uint16_t (*putc_fn)(char, const unsigned char*, uint16_t, uint16_t),
+						   const unsigned char *font, uint16_t y, int repeats)
+{
+	clock_t start = clock();
+	int r, c;
+
+	for (r = 0; r < repeats; r++)
+	{
+		for (c = 0; c < font[3]; c++)
+		{
+			putc_fn(font[2] + c, font, (c * 7) % LCDWIDTH, y);
+		}
+	}
+
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t before[1024], expected[1024];
+	unsigned long placements = 0, failures = 0;
+	int repeats = (argc > 1) ? atoi(argv[1]) : 2000;
+	unsigned f;
+	int c, x, y;
+
+	srand(1);
+
+	for (f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++)
+	{
+		const unsigned char *font = fonts[f].font;
+
+		for (c = 0; c < font[3]; c++)
+		{
+			fill_random(before);
+
+			for (y = 0; y <= LCDHEIGHT + 1; y++)
+			{
+				for (x = 0; x <= LCDWIDTH + 3; x++)
+				{
+					uint16_t ref_width, width;
+
+					memcpy(buffer, before, sizeof(buffer));
+					ref_width = reference_putc(font[2] + c, font, x, y);
+					memcpy(expected, buffer, sizeof(buffer));
+
+					memcpy(buffer, before, sizeof(buffer));
+					width = mugui_lcd_putc(font[2] + c, font, x, y);
+
+					placements++;
+					if ((width != ref_width) || memcmp(buffer, expected, sizeof(buffer)))
+					{
+						if (failures++ < 10)
+						{
+							printf("MISMATCH %s char %d at x=%d y=%d\n", fonts[f].name, font[2] + c, x, y);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	printf("%lu placements, %lu mismatches\n", placements, failures);
+
+	printf("%-10s %10s %10s\n", "font", "aligned", "unaligned");
+	for (f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++)
+	{
+		double ref_a = time_charset(reference_putc, fonts[f].font, 8, repeats);
+		double new_a = time_charset(mugui_lcd_putc, fonts[f].font, 8, repeats);
+		double ref_u = time_charset(reference_putc, fonts[f].font, 3, repeats);
+		double new_u = time_charset(mugui_lcd_putc, fonts[f].font, 3, repeats);
+
+		printf("%-10s %9.1fx %9.1fx\n", fonts[f].name, ref_a / new_a, ref_u / new_u);
+	}
+
+	return failures ? 1 : 0;
+}